@@ -1,27 +1,254 @@
 #pragma once
 
 #include "data/DataSet.hpp"
+#include "data/DataLoader.hpp"
 #include "Solution.hpp"
+#include "PopulationMatrix.hpp"
 #include "algorithms/1NN.hpp"
 #include "data/EvaluatedSolution.hpp"
+#include "FitnessCache.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+/**
+ * @brief The fitness of a solution together with the rates it is computed from.
+ */
+struct EvaluationResult {
+    float classificationRate; /**< The leave-one-out classification rate. */
+    float reductionRate; /**< The reduction rate. */
+    float fitness; /**< The fitness value. */
+};
+
 class Evaluation {
 private:
     OneNN nn;
     float alpha;
     float reductionThreshold;
     std::vector<float> fitnessRecords;
+    std::vector<float> differenceTensor; /**< Squared differences of the tensorFeatures of every pair of training instances, one row per pair. */
+    std::vector<uint32_t> tensorFeatures; /**< The features that are not constant across the training data, one column of the tensor each. */
+    std::atomic<bool> differenceTensorBuilt{false}; /**< Whether differenceTensor holds the tensor of the training data. */
+    std::mutex differenceTensorMutex; /**< Serializes building the tensor when several threads evaluate at once. */
+    FitnessCache fitnessCache; /**< Leave-one-out classification rates on the training data by reduced solution. */
+    std::unique_ptr<std::atomic<uint32_t>[]> previousNearest; /**< The last leave-one-out nearest neighbor of every training instance, used to seed the next search. */
+    size_t memoryBudget; /**< Maximum size in bytes of the rows copied for one evaluation. */
+    DataLoader::UniqueRows uniqueRows; /**< The distinct training rows and their multiplicities, when deduplicated. */
+    bool deduplicated = false; /**< Whether leave-one-out on the training data scans uniqueRows instead of every row. */
+    size_t solutionThreads = 0; /**< The groups of threads evaluateBatch spreads the solutions over, 0 to choose automatically. */
+
+    /**
+     * @brief Chooses how many groups of threads evaluateBatch splits the solutions into.
+     *
+     * The threads of a group share the instance-level work of its solutions.
+     * Unless set with setSolutionThreads, there are just enough groups for
+     * every thread of a group to have one of the blocks of work.
+     *
+     * @param numThreads The threads available to the evaluation.
+     * @param numSolutions The number of solutions to evaluate.
+     * @param numBlocks The number of blocks of instance-level work per solution.
+     * @return The number of groups, between 1 and the smaller of numThreads and numSolutions.
+     */
+    size_t numSolutionGroups(size_t numThreads, size_t numSolutions, size_t numBlocks) const;
+
+    /**
+     * @brief Returns the rows scanned by leave-one-out on the training data.
+     * @return The distinct training rows when deduplicated, otherwise the training data.
+     */
+    const DataSet& leaveOneOutData() const { return deduplicated ? uniqueRows.rows : nn.getTrainingData(); }
+
+    /**
+     * @brief Counts the training instances a row of leaveOneOutData() classifies correctly under leave-one-out.
+     *
+     * Without deduplication this is whether the nearest other row has the
+     * same class. With it, the row stands for all its copies: each one has
+     * the others at distance zero, with its own class, and only loses to the
+     * nearest distinct row if that is also at distance zero and comes earlier
+     * in the training data. The earliest other copy is the second one for the
+     * first copy and the first one for the rest.
+     *
+     * @param row The index of the row in leaveOneOutData().
+     * @param nearestIndex The nearest other row of leaveOneOutData(), or an out of range index if there is none.
+     * @param nearestDistance Its squared distance to the row.
+     * @return The number of correctly classified training instances the row stands for.
+     */
+    size_t countCorrectCopies(size_t row, size_t nearestIndex, float nearestDistance) const;
+
+    /**
+     * @brief Counts the instances of a dataset whose nearest training instance has the same class.
+     *
+     * Parallelism is applied at a single level: over the queries when there
+     * are enough of them for every thread, otherwise over the training
+     * instances scanned for each query. Both use static chunks and per-thread
+     * partial results, and nothing runs in parallel when called from inside a
+     * parallel region. Leave-one-out on the training data itself goes through
+     * the symmetric all-pairs scan of countCorrectLeaveOneOut instead, and
+     * training data whose active features do not fit in the memory budget
+     * through the blocked scan of countCorrectBlocked.
+     *
+     * @param dataset The instances to classify.
+     * @param reducedSolution The reduced solution whose weights are used.
+     * @param leaveOneOut Whether instance i is excluded when classifying query i.
+     * @return The number of correct predictions.
+     */
+    size_t countCorrectPredictions(const DataSet& dataset, const Solution& reducedSolution, bool leaveOneOut);
+
+    /**
+     * @brief Counts the correct predictions of countCorrectPredictions for sparse training data.
+     *
+     * The weighted squared norm of every row is computed once, so every
+     * distance only merges the features stored in both rows. The queries are
+     * split across threads and every scan keeps the lowest index on ties.
+     *
+     * @param dataset The instances to classify.
+     * @param reducedSolution The reduced solution whose weights are used.
+     * @param leaveOneOut Whether instance i is excluded when classifying query i.
+     * @return The number of correct predictions.
+     */
+    size_t countCorrectSparse(const DataSet& dataset, const Solution& reducedSolution, bool leaveOneOut);
+
+    /**
+     * @brief Counts the correct predictions of countCorrectPredictions without holding all the rows in memory.
+     *
+     * The queries are taken in blocks, and for every query block the training
+     * instances are streamed in blocks of the same size, in index order, so
+     * every query keeps the lowest index on ties. While a training block is
+     * scanned, with the queries split across threads, a background thread
+     * already copies the next one out of the dataset, so reading a mapped
+     * dataset from disk overlaps the distance computations. One query block
+     * and two training blocks are held at a time, together within the memory
+     * budget.
+     *
+     * @param dataset The instances to classify.
+     * @param layout The active features of the reduced solution, without rows.
+     * @param leaveOneOut Whether instance i is excluded when classifying query i.
+     * @return The number of correct predictions.
+     */
+    size_t countCorrectBlocked(const DataSet& dataset, const OneNN::SearchData& layout, bool leaveOneOut);
+
+    /**
+     * @brief Counts the correct leave-one-out predictions on the training data with a symmetric all-pairs scan.
+     *
+     * The rows scanned are those of leaveOneOutData(), weighted by
+     * countCorrectCopies.
+     *
+     * The upper triangle of the distance matrix is walked in square tiles of
+     * LOO_TILE_BYTES worth of rows, and every distance updates the running
+     * nearest neighbor of both instances of the pair, so each distance is
+     * computed once. Every thread keeps its own nearest neighbors, seeded from
+     * the previous evaluation, and abandons a pair once its partial distance
+     * exceeds both of its bounds; the per-thread minima are merged at the end,
+     * the lowest index winning ties.
+     *
+     * @param search The training data laid out for the reduced solution.
+     * @return The number of correct predictions.
+     */
+    size_t countCorrectLeaveOneOut(const OneNN::SearchData& search);
+
+    /**
+     * @brief Finds the leave-one-out classification rate and the fitness of reduced solutions.
+     * 
+     * This is the core of evaluateBatch, which reduces the solutions and sets
+     * the reduction rate of every result beforehand.
+     * 
+     * @param candidates The reduced solutions, moved from when they are not in the fitness cache.
+     * @param results The result of every solution, whose classification rate and fitness are set.
+     */
+    void classifyBatch(std::vector<Solution>& candidates, std::vector<EvaluationResult>& results);
+
+    /**
+     * @brief Builds the cached difference tensor if it fits in BATCH_MEMORY_BUDGET.
+     * 
+     * Features constant across the training data are left out, as their
+     * differences are all zero. Threads that evaluate concurrently, such as
+     * the islands of IslandGA, wait for the first one to build it.
+     * 
+     * @return True if the cached tensor is available.
+     */
+    bool buildDifferenceTensor();
 
 public:
+    static constexpr size_t MIN_QUERIES_PER_THREAD = 4; /**< Queries per thread needed to parallelize over queries. */
+    static constexpr size_t MIN_SPLIT_SCAN_WORK = size_t(1) << 16; /**< Distance terms per query needed to split a scan among threads. */
+    static constexpr size_t LOO_TILE_BYTES = size_t(64) << 10; /**< Size in bytes of the rows of one tile of the all-pairs scan. */
+    static constexpr size_t BATCH_MEMORY_BUDGET = size_t(256) << 20; /**< Maximum size in bytes of the cached difference tensor. */
+    static constexpr size_t BATCH_BLOCK_BYTES = size_t(256) << 10; /**< Size in bytes of the block of pair differences multiplied at once. */
+    static constexpr size_t DEFAULT_FITNESS_CACHE_CAPACITY = size_t(64) << 20; /**< Default size in bytes of the fitness cache. */
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(4) << 30; /**< Default maximum size in bytes of the rows copied for one evaluation. */
+
     /**
      * @brief Constructor of the Evaluation class.
      * 
-     * @param trainingData The training dataset.
+     * @param trainingData The training dataset. Its rows are shared rather than copied, so it must
+     *                     outlive the evaluation and its rows must not change.
      * @param alpha The alpha value.
      * @param reductionThreshold The reduction threshold.
+     * @param fitnessCacheCapacity The size in bytes of the fitness cache, 0 to disable it.
+     * @param memoryBudget The maximum size in bytes of the rows copied for one evaluation.
+     * @param deduplicate Whether leave-one-out on the training data scans its distinct rows only, weighted by
+     *                    their multiplicities. Sparse and out-of-core training data is never deduplicated.
      */
-    Evaluation(const DataSet& trainingData, float alpha, float reductionThreshold);
+    Evaluation(const DataSet& trainingData, float alpha, float reductionThreshold,
+               size_t fitnessCacheCapacity = DEFAULT_FITNESS_CACHE_CAPACITY,
+               size_t memoryBudget = DEFAULT_MEMORY_BUDGET, bool deduplicate = false);
+
+    /**
+     * @brief Sets how the threads of evaluateBatch are split between solutions and instances.
+     * 
+     * The threads are divided into the given number of groups, each
+     * evaluating its own share of the solutions with the rest of the threads
+     * working on the instances. The classification rates do not depend on the
+     * split, only on the solutions.
+     * 
+     * @param threads The number of groups, or 0 to choose it for every batch.
+     */
+    void setSolutionThreads(size_t threads) { solutionThreads = threads; }
+
+    /**
+     * @brief Returns the number of rows scanned by leave-one-out on the training data.
+     * 
+     * @return The number of distinct training rows when deduplicated, otherwise the number of training instances.
+     */
+    size_t getNumLeaveOneOutRows() const { return leaveOneOutData().size(); }
+
+    /**
+     * @brief Returns the threshold below which a weight is treated as zero.
+     * 
+     * @return The reduction threshold.
+     */
+    float getReductionThreshold() const { return reductionThreshold; }
+
+    /**
+     * @brief Returns the cache of leave-one-out classification rates on the training data.
+     * 
+     * @return The fitness cache, whose hit and miss counters can be read.
+     */
+    FitnessCache& getFitnessCache() { return fitnessCache; }
+
+    /**
+     * @brief Checks whether the training data is too large to be held in memory.
+     * 
+     * The rows of such training data are only read in blocks, so evaluations
+     * that need all of them at once are skipped.
+     * 
+     * @return True if the dense training rows exceed the memory budget.
+     */
+    bool isOutOfCore() const;
+
+    /**
+     * @brief Checks whether a dataset holds the training data of the evaluation.
+     * 
+     * The evaluation reads the rows of the dataset it was built from, so that
+     * dataset and any view over the same rows are recognized in
+     * constant time. Any other dataset is evaluated as a separate one, even
+     * with the same contents.
+     * 
+     * @param dataset The dataset to check.
+     * @return True if the dataset reads the same rows as the training data.
+     */
+    bool isTrainingData(const DataSet& dataset) const;
 
     /**
      * @brief Returns the fitness records.
@@ -45,9 +272,21 @@ public:
      */
     Solution reduceSolution(const Solution& solution);
 
+    /**
+     * @brief Reduces a row of weights by setting those below a threshold to zero.
+     * 
+     * @param weights The weights to reduce.
+     * @param numWeights The number of weights.
+     * @return The reduced solution.
+     */
+    Solution reduceWeights(const float* weights, size_t numWeights);
+
     /**
      * @brief Evaluates the fitness of a solution using leave-one-out cross-validation.
      * 
+     * When the dataset holds the training data the result is memoized in the
+     * fitness cache.
+     * 
      * @param dataset The dataset on which the solution will be evaluated.
      * @param solution The solution to be evaluated.
      * @return The fitness of the solution.
@@ -71,6 +310,15 @@ public:
      */
     float calculateReductionRate(const Solution& solution);
 
+    /**
+     * @brief Calculates the reduction rate for a row of weights.
+     *
+     * @param weights The weights to evaluate.
+     * @param numWeights The number of weights.
+     * @return The reduction rate.
+     */
+    float calculateReductionRate(const float* weights, size_t numWeights);
+
     /**
      * @brief Calculates the fitness value for a given solution.
      *
@@ -98,6 +346,38 @@ public:
      */
     float calculateFitnessLeaveOneOut(const DataSet& dataset, const Solution& solution);
 
+    /**
+     * @brief Evaluates a set of solutions with leave-one-out cross-validation on the training data.
+     *
+     * The weighted squared distances of all pairs of training instances are
+     * obtained for every solution at once as the product of the pair x feature
+     * matrix of squared differences and the feature x solution matrix of
+     * reduced weights. The product is done by blocks of pairs, and the
+     * difference matrix is cached when it fits in BATCH_MEMORY_BUDGET. Solutions
+     * found in the fitness cache are not recomputed. When deduplicated, the
+     * pairs are those of the distinct rows.
+     *
+     * The threads are split between solutions and instances as chosen by
+     * numSolutionGroups: every group multiplies the blocks of pairs by the
+     * weights of its own solutions, and the threads of a group take separate
+     * ranges of blocks, each keeping its own nearest neighbors until they are
+     * merged with the lowest index winning ties. Sparse solutions, which are
+     * scanned one by one, are spread over the groups the same way, with the
+     * threads of a group splitting every scan.
+     *
+     * @param solutions The solutions to evaluate.
+     * @return The classification rate, reduction rate and fitness of every solution.
+     */
+    std::vector<EvaluationResult> evaluateBatch(const std::vector<Solution>& solutions);
+
+    /**
+     * @brief Evaluates every individual of a population matrix, as evaluateBatch does for solutions.
+     *
+     * @param population The individuals to evaluate, one per row.
+     * @return The classification rate, reduction rate and fitness of every row.
+     */
+    std::vector<EvaluationResult> evaluateBatch(const PopulationMatrix& population);
+
     /**
      * @brief Evaluates a solution using the classification rate, reduction rate, and alpha value.
      *
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class FitnessCache
+ * @brief Thread-safe memo of leave-one-out classification rates keyed on reduced weights, bounded in bytes.
+ *
+ * Two solutions that only differ in weights below the reduction threshold are
+ * identical once reduced, so they classify exactly the same. The cache maps the
+ * reduced weight vector to its classification rate. Only the non-zero weights
+ * of a key are stored, with their indices, so a key costs memory in proportion
+ * to the features a solution keeps rather than to the number of features.
+ * Entries are spread over independently locked shards, each evicting its least
+ * recently used entries when the bytes of its entries would exceed its share of
+ * the capacity. Keys are hashed, and the stored weights are compared on lookup
+ * so hash collisions never return a wrong rate.
+ */
+class FitnessCache {
+private:
+    static constexpr size_t NUM_SHARDS = 16; /**< The number of independently locked shards. */
+
+    /**
+     * @brief A cached reduced weight vector and its classification rate.
+     */
+    struct Entry {
+        uint64_t hash; /**< The hash of the weights. */
+        size_t numWeights; /**< The number of weights, zeros included. */
+        std::vector<uint32_t> indices; /**< The indices of the non-zero weights, in increasing order. */
+        std::vector<float> values; /**< The non-zero weights. */
+        float classificationRate; /**< The classification rate of the weights. */
+    };
+
+    /**
+     * @brief A part of the cache guarded by its own mutex.
+     */
+    struct Shard {
+        std::mutex mutex; /**< Guards the entries, the index and the byte count. */
+        std::list<Entry> entries; /**< The entries, most recently used first. */
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index; /**< The entry of every hash. */
+        size_t bytes = 0; /**< The bytes taken by the entries, as counted by entryBytes. */
+    };
+
+    std::array<Shard, NUM_SHARDS> shards; /**< The shards of the cache. */
+    size_t capacity; /**< The maximum number of bytes taken by the entries. */
+    size_t shardCapacity; /**< The maximum number of bytes taken by the entries of a shard. */
+    std::atomic<size_t> hits{0}; /**< The number of successful lookups. */
+    std::atomic<size_t> misses{0}; /**< The number of failed lookups. */
+
+    /**
+     * @brief Hashes the non-zero weights of a vector bit by bit, with their indices.
+     * @param weights The weights to hash.
+     * @return The hash of the weights.
+     */
+    static uint64_t hashWeights(const std::vector<float>& weights);
+
+    /**
+     * @brief Checks whether an entry holds a weight vector.
+     * @param entry The entry.
+     * @param weights The weights, zeros included.
+     * @return True if the entry stores exactly the non-zero weights of the vector.
+     */
+    static bool matches(const Entry& entry, const std::vector<float>& weights);
+
+    /**
+     * @brief Estimates the memory taken by an entry, its list node and its index node.
+     * @param numNonZero The number of non-zero weights of the entry.
+     * @return The size in bytes.
+     */
+    static size_t entryBytes(size_t numNonZero);
+
+public:
+    /**
+     * @brief Constructor of the FitnessCache class.
+     * @param capacity The maximum number of bytes taken by the entries. A capacity of 0 disables the cache.
+     */
+    explicit FitnessCache(size_t capacity);
+
+    /**
+     * @brief Looks up the classification rate of a reduced weight vector.
+     * @param reducedWeights The reduced weights.
+     * @param classificationRate Set to the cached rate on a hit.
+     * @return True on a hit.
+     */
+    bool find(const std::vector<float>& reducedWeights, float& classificationRate);
+
+    /**
+     * @brief Stores the classification rate of a reduced weight vector.
+     * @param reducedWeights The reduced weights.
+     * @param classificationRate The classification rate.
+     */
+    void insert(const std::vector<float>& reducedWeights, float classificationRate);
+
+    /**
+     * @brief Checks whether the cache stores anything.
+     * @return False if the capacity is 0.
+     */
+    bool isEnabled() const { return capacity > 0; }
+
+    /**
+     * @brief Returns the number of successful lookups.
+     * @return The number of hits.
+     */
+    size_t getHits() const { return hits.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the number of failed lookups.
+     * @return The number of misses.
+     */
+    size_t getMisses() const { return misses.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Removes every entry and resets the counters.
+     */
+    void clear();
+};
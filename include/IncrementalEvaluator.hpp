@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Evaluation.hpp"
+#include "data/DataSet.hpp"
+#include "Solution.hpp"
+
+#include <memory>
+#include <vector>
+
+/**
+ * @class IncrementalEvaluator
+ * @brief Leave-one-out evaluation of solutions that differ from the current one in a single weight.
+ *
+ * The evaluator keeps the N x N matrix of weighted squared distances between
+ * all pairs of instances for the current (reduced) solution. Changing weight k
+ * by dw moves every distance by dw * (x_ik - x_jk)^2, so a neighbor is scored
+ * in O(N^2) instead of the O(N^2 * d) of a full leave-one-out pass. Full
+ * recomputations only go through the active features of the solution.
+ *
+ * A move is first proposed, which only scores it, and then either committed,
+ * which applies it to the matrix, or rolled back. The matrix is recomputed from
+ * scratch every few commits to bound the floating point drift of the updates.
+ * When the matrix would not fit in the memory budget the evaluator falls back
+ * to full evaluations through the wrapped Evaluation object.
+ *
+ * The dataset is used both as the instances to classify and as the training
+ * set, as in Evaluation::calculateFitnessLeaveOneOut on the training data.
+ * Proposed moves are looked up in the fitness cache of the evaluation when
+ * the dataset holds its training data, but never added to it: the rates
+ * computed here come from updated distances and another distance kernel, so
+ * a near tie may resolve differently than in Evaluation, and caching them
+ * would make later evaluations depend on which moves were scored before.
+ */
+class IncrementalEvaluator {
+private:
+    std::shared_ptr<Evaluation> eval; /**< The evaluation object providing the fitness function. */
+    const DataSet& dataset; /**< The dataset the solutions are evaluated on. */
+    size_t resyncInterval; /**< The number of commits between two full recomputations of the matrix. */
+    bool enabled; /**< Whether the dataset is dense and in memory, and the distance matrix fits in the memory budget. */
+
+    std::vector<float> distances; /**< Row-major N x N weighted squared distances. */
+    std::vector<float> weights; /**< The reduced weights of the current solution. */
+    std::vector<bool> constantFeatures; /**< Whether each feature is constant across the dataset, so its weight never moves a distance. */
+    std::vector<float> column; /**< Copy of the feature column of columnIndex. */
+    size_t columnIndex; /**< The feature held in column, or the number of features if none. */
+    bool cacheable; /**< Whether the dataset holds the training data, so the rates of the fitness cache apply. */
+    float classificationRate; /**< The leave-one-out classification rate of the current solution. */
+    size_t commitsSinceResync; /**< The number of commits since the matrix was last recomputed. */
+
+    size_t pendingIndex; /**< The weight changed by the last proposed move. */
+    float pendingWeight; /**< The reduced value of the weight changed by the last proposed move. */
+    float pendingRate; /**< The classification rate of the last proposed move. */
+    bool hasPending; /**< Whether a move has been proposed and not yet committed or rolled back. */
+
+    /**
+     * @brief Recomputes the distance matrix and the classification rate from the current weights.
+     */
+    void resync();
+
+    /**
+     * @brief Copies a feature column of the dataset into column.
+     *
+     * @param index The index of the feature.
+     */
+    void loadColumn(size_t index);
+
+    /**
+     * @brief Returns the fitness of a solution given its classification rate.
+     *
+     * @param solution The solution, used for the reduction rate.
+     * @param rate The leave-one-out classification rate.
+     * @return The fitness value.
+     */
+    float fitnessOf(const Solution& solution, float rate) const;
+
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(512) << 20; /**< Default budget in bytes for the distance matrix. */
+
+    /**
+     * @brief Constructor of the IncrementalEvaluator class.
+     *
+     * @param eval The evaluation object providing the fitness function.
+     * @param dataset The dataset the solutions are evaluated on. Must outlive the evaluator.
+     * @param memoryBudget The maximum size in bytes of the distance matrix.
+     * @param resyncInterval The number of commits between two full recomputations of the matrix.
+     */
+    IncrementalEvaluator(std::shared_ptr<Evaluation> eval, const DataSet& dataset,
+        size_t memoryBudget = DEFAULT_MEMORY_BUDGET, size_t resyncInterval = 100);
+
+    /**
+     * @brief Checks whether moves are scored incrementally.
+     *
+     * @return False if the evaluator falls back to full evaluations.
+     */
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * @brief Makes the given solution the current one.
+     *
+     * @param solution The new current solution.
+     * @return The leave-one-out fitness of the solution.
+     */
+    float reset(const Solution& solution);
+
+    /**
+     * @brief Scores a neighbor of the current solution.
+     *
+     * @param neighbor The neighbor, equal to the current solution except for one weight.
+     * @param index The index of the weight that differs.
+     * @return The leave-one-out fitness of the neighbor.
+     */
+    float propose(const Solution& neighbor, size_t index);
+
+    /**
+     * @brief Makes the last proposed neighbor the current solution.
+     */
+    void commit();
+
+    /**
+     * @brief Discards the last proposed neighbor.
+     */
+    void rollback();
+};
@@ -0,0 +1,141 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Solution.hpp"
+#include "utils/AlignedAllocator.hpp"
+
+/**
+ * @class PopulationMatrix
+ * @brief A population of solutions stored as one row-major matrix, with the fitness of every row.
+ *
+ * Every row holds the weights of one individual, starts on a ROW_ALIGNMENT
+ * boundary and occupies getStride() floats, so the operators run as
+ * vectorized loops over rows and a whole population can be multiplied as a
+ * single matrix. Resizing keeps the buffer, so a matrix reused from one
+ * generation to the next allocates no memory.
+ */
+class PopulationMatrix {
+public:
+    static constexpr size_t ROW_ALIGNMENT = 64; /**< Alignment in bytes of every row. */
+
+private:
+    std::vector<float, AlignedAllocator<float, ROW_ALIGNMENT>> weights; /**< Row-major weight buffer. */
+    std::vector<float> fitness; /**< The fitness of every row. */
+    size_t numRows; /**< The number of individuals. */
+    size_t numWeights; /**< The number of weights of every individual. */
+    size_t stride; /**< The distance in floats between the start of two consecutive rows. */
+
+public:
+    /**
+     * @brief Constructs a matrix of the given size, with every weight and fitness zero.
+     * @param numRows The number of individuals.
+     * @param numWeights The number of weights of every individual.
+     */
+    explicit PopulationMatrix(size_t numRows = 0, size_t numWeights = 0);
+
+    /**
+     * @brief Constructs a matrix holding the weights of some solutions, with zero fitness.
+     * @param solutions The solutions, all with the same number of weights.
+     * @return The matrix with one row per solution, in order.
+     */
+    static PopulationMatrix fromSolutions(const std::vector<Solution>& solutions);
+
+    /**
+     * @brief Changes the size of the matrix, keeping its buffer.
+     *
+     * The rows kept are unchanged when the number of weights is; otherwise the
+     * contents are unspecified.
+     *
+     * @param numRows The number of individuals.
+     * @param numWeights The number of weights of every individual.
+     */
+    void resize(size_t numRows, size_t numWeights);
+
+    /**
+     * @brief Returns the number of individuals.
+     * @return The number of rows.
+     */
+    size_t size() const { return numRows; }
+
+    /**
+     * @brief Returns the number of weights of every individual.
+     * @return The number of columns.
+     */
+    size_t getNumWeights() const { return numWeights; }
+
+    /**
+     * @brief Returns the distance between two consecutive rows.
+     * @return The row stride in floats.
+     */
+    size_t getStride() const { return stride; }
+
+    /**
+     * @brief Returns the weights of an individual.
+     * @param index The row of the individual.
+     * @return Pointer to its first weight, aligned to ROW_ALIGNMENT.
+     */
+    float* row(size_t index) { return weights.data() + index * stride; }
+
+    /**
+     * @brief Returns the weights of an individual.
+     * @param index The row of the individual.
+     * @return Pointer to its first weight, aligned to ROW_ALIGNMENT.
+     */
+    const float* row(size_t index) const { return weights.data() + index * stride; }
+
+    /**
+     * @brief Returns the fitness of every individual.
+     * @return One value per row.
+     */
+    std::vector<float>& getFitness() { return fitness; }
+
+    /**
+     * @brief Returns the fitness of every individual.
+     * @return One value per row.
+     */
+    const std::vector<float>& getFitness() const { return fitness; }
+
+    /**
+     * @brief Returns the row of the best individual.
+     * @return The row with the highest fitness, the first one on ties.
+     */
+    size_t bestIndex() const;
+
+    /**
+     * @brief Copies an individual out of the matrix.
+     * @param index The row of the individual.
+     * @return A solution with its weights.
+     */
+    Solution getSolution(size_t index) const;
+
+    /**
+     * @brief Overwrites the weights of an individual.
+     * @param index The row of the individual.
+     * @param solution The solution whose weights are copied.
+     */
+    void setSolution(size_t index, const Solution& solution);
+
+    /**
+     * @brief Copies an individual and its fitness from another matrix.
+     * @param index The row to overwrite.
+     * @param source The matrix to copy from, with the same number of weights.
+     * @param sourceIndex The row to copy.
+     */
+    void copyRow(size_t index, const PopulationMatrix& source, size_t sourceIndex);
+
+    /**
+     * @brief Computes the variance of every weight over the population.
+     *
+     * The rows are accumulated one after the other into a vector of sums, so
+     * the loops run across the weights.
+     *
+     * @return The population variance of every column.
+     */
+    std::vector<float> weightVariances() const;
+
+    /**
+     * @brief Exchanges the contents of two matrices without copying them.
+     * @param other The matrix to swap with.
+     */
+    void swap(PopulationMatrix& other);
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <iosfwd>
 #include <vector>
 
 /**
@@ -11,6 +12,11 @@ class Solution {
 public:
     std::vector<float> weights; /**< The vector of weights of the solution **/
 
+    /**
+     * @brief Tag that selects the constructor which leaves the weights to the caller.
+     */
+    struct Uninitialized {};
+
     /**
      * @brief Construct a new Solution object.
      * 
@@ -26,6 +32,19 @@ public:
      */
     Solution(size_t numberOfFeatures, float value);
 
+    /**
+     * @brief Construct a new Solution object whose weights the caller is about to overwrite.
+     * 
+     * No random numbers are drawn, so operators that fill every weight of their
+     * results neither waste time nor disturb the random sequence.
+     * 
+     * @param numberOfFeatures The number of features in the solution.
+     */
+    Solution(size_t numberOfFeatures, Uninitialized);
+
+    Solution(const Solution& other) = default;
+    Solution(Solution&& other) noexcept = default;
+
     /**
      * @brief Initialize the weights randomly.
      * 
@@ -59,12 +78,21 @@ public:
     /**
      * @brief Overloaded assignment operator.
      * 
-     * This function allows one Solution object to be assigned to another.
+     * This function allows one Solution object to be assigned to another. The
+     * weights are copied into the existing buffer when it is large enough.
      * 
      * @param other The Solution object to assign.
      * @return The Solution object.
      */
-    Solution& operator=(const Solution& other); 
+    Solution& operator=(const Solution& other) = default;
+
+    /**
+     * @brief Move assignment operator, which takes over the weights of the other solution.
+     * 
+     * @param other The Solution object to move from.
+     * @return The Solution object.
+     */
+    Solution& operator=(Solution&& other) noexcept = default;
 
     /**
      * @brief Overloaded addition operator.
@@ -1,9 +1,57 @@
 #pragma once
 
 #include "algorithms/KNNClassifier.hpp"
+#include "utils/AlignedAllocator.hpp"
+
+#include <cstdint>
+#include <vector>
 
 class OneNN : public KNNClassifier {
+private:
+    std::vector<bool> constantFeatures; /**< Whether each feature takes the same value in every training instance. */
+
 public:
+    static constexpr size_t NO_INDEX = static_cast<size_t>(-1); /**< Marks that no training instance is excluded or found. */
+
+    /**
+     * @brief The nearest training instance found in a scan.
+     */
+    struct Neighbor {
+        float distance; /**< The squared distance to the test row. */
+        size_t index; /**< The index of the training instance, or NO_INDEX if none was scanned. */
+    };
+
+    /**
+     * @brief The training data laid out for the searches of one solution.
+     *
+     * Only the active features are kept: those with a nonzero weight that are
+     * not constant across the training data, since the others cannot change
+     * which instance is the nearest. They are stored by descending weight, so
+     * the partial distance of a candidate grows as fast as possible and the
+     * search can abandon it early. Test rows must be permuted into the same
+     * order before searching.
+     */
+    struct SearchData {
+        std::vector<uint32_t> order; /**< The original index of every active feature in search order. */
+        std::vector<float> weights; /**< The weights in search order. */
+        std::vector<float, AlignedAllocator<float, DataSet::ROW_ALIGNMENT>> rows; /**< The training rows in search order. */
+        size_t stride = 0; /**< The distance in floats between two consecutive rows. */
+
+        /**
+         * @brief Returns the features of a training row in search order.
+         * @param index The index of the training instance.
+         * @return Pointer to the first feature of the row.
+         */
+        const float* row(size_t index) const { return rows.data() + index * stride; }
+
+        /**
+         * @brief Copies the features of a test row into search order.
+         * @param testRow The test row.
+         * @param out Destination with room for stride floats.
+         */
+        void permute(const DataRow& testRow, float* out) const;
+    };
+
     /** 
      * Constructor of the OneNN class with the euclidean distance.
      * 
@@ -12,22 +60,122 @@ public:
     */
     OneNN(const DataSet& originalTrainingData);
 
+    /**
+     * Lays out the training data for the searches of one solution.
+     * 
+     * @param solution The solution containing the weights of the features.
+     * @return The active features of the training data in descending weight order.
+     */
+    SearchData prepare(const Solution& solution) const;
+
+    /**
+     * Chooses the active features and their search order for one set of weights, without copying any row.
+     * 
+     * @param weights The weights of the features.
+     * @param constantFeatures Whether each feature is constant across the dataset.
+     * @return The search layout with an empty rows buffer.
+     */
+    static SearchData layout(const std::vector<float>& weights, const std::vector<bool>& constantFeatures);
+
+    /**
+     * Lays out a dataset for the searches of one set of weights.
+     * 
+     * @param data The dataset to lay out.
+     * @param weights The weights of the features.
+     * @param constantFeatures Whether each feature is constant across the dataset.
+     * @return The active features of the dataset in descending weight order.
+     */
+    static SearchData prepare(const DataSet& data, const std::vector<float>& weights,
+                              const std::vector<bool>& constantFeatures);
+
+    /**
+     * Returns which features are constant across the training data.
+     * 
+     * @return For every feature, whether it takes the same value in every training instance.
+     */
+    const std::vector<bool>& getConstantFeatures() const { return constantFeatures; }
+
+    /**
+     * Computes the squared distance between a test row and a training instance.
+     * 
+     * @param search The training data of the solution.
+     * @param query The test row in search order.
+     * @param index The index of the training instance.
+     * @return The training instance and its squared distance to the test row.
+     */
+    Neighbor distanceTo(const SearchData& search, const float* query, size_t index) const;
+
+    /**
+     * Finds the nearest neighbor of a test row among a range of training instances.
+     * 
+     * Squared distances are compared, and a candidate is abandoned as soon as
+     * its partial distance exceeds the best one found so far. The search starts
+     * from a seed, typically the nearest neighbor of the row in a previous
+     * search, which gives a tight bound from the first candidate. Ties are
+     * resolved in favour of the lowest index, so neither the seed nor the way
+     * the training data is split into ranges changes the result.
+     * 
+     * @param search The training data of the solution.
+     * @param query The test row in search order.
+     * @param excludeIndex The index of a training instance to skip, or NO_INDEX.
+     * @param begin The first training instance of the range.
+     * @param end One past the last training instance of the range.
+     * @param seed The best neighbor known before the scan, with index NO_INDEX if none.
+     * @return The nearest of the seed and the training instances of the range.
+     */
+    Neighbor nearestNeighbor(const SearchData& search, const float* query, size_t excludeIndex,
+                             size_t begin, size_t end, Neighbor seed) const;
+
+    /**
+     * Classifies a test item against training data already laid out for its solution.
+     * 
+     * Callers classifying many rows with the same solution prepare it once
+     * and pass it to every call.
+     * 
+     * @param search The training data of the solution, from prepare.
+     * @param testRow The test row to classify.
+     * @param excludeIndex The index of a training instance to skip, or NO_INDEX.
+     * @return The predicted class, as an identifier of the training dataset.
+     */
+    ClassId classify(const SearchData& search, const DataRow& testRow, size_t excludeIndex = NO_INDEX) const;
+
     /**
      * Classifies a test item using the nearest neighbor algorithm.
      * 
-     * @param testItem The test item to classify.
+     * A single query scans the training rows directly rather than laying them
+     * out, which would cost as much as the scan itself.
+     * 
+     * @param testRow The test row to classify.
      * @param weights The weights of the features.
-     * @return std::string The predicted label.
+     * @return ClassId The predicted class, as an identifier of the training dataset.
      */
-    virtual std::string classify(const DataItem& testItem, const Solution& weights) const override;
+    virtual ClassId classify(const DataRow& testRow, const Solution& weights) const override;
 
     /**
      * Classifies a test item using the nearest neighbor algorithm, excluding the feature at the given index.
      * 
-     * @param testItem The test item to classify.
+     * @param testRow The test row to classify.
      * @param excludeIndex The index of the feature to exclude.
      * @param solution The solution containing the weights of the features.
-     * @return The predicted label.
+     * @return The predicted class, as an identifier of the training dataset.
+     */
+    virtual ClassId classifyExcludingIndex(const DataRow& testRow, size_t excludeIndex, const Solution& solution) override;
+
+    /**
+     * Returns an empty seed for nearestNeighbor.
+     * 
+     * @return A neighbor at infinite distance with index NO_INDEX.
+     */
+    static Neighbor noNeighbor();
+
+private:
+    /**
+     * Finds the nearest training instance of a single test row, reading the training rows in their own order.
+     * 
+     * @param testRow The test row.
+     * @param excludeIndex The index of a training instance to skip, or NO_INDEX.
+     * @param solution The solution containing the weights of the features.
+     * @return The nearest training instance, with index NO_INDEX if none was scanned.
      */
-    virtual std::string classifyExcludingIndex(const DataItem& testItem, size_t excludeIndex, const Solution& solution) override;
+    Neighbor nearestNeighbor(const DataRow& testRow, size_t excludeIndex, const Solution& solution) const;
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "algorithms/Algorithm.hpp"
+#include "algorithms/GA.hpp"
+#include "Evaluation.hpp"
+
+/**
+ * @class AsyncSGA
+ * @brief An asynchronous steady-state genetic algorithm that evaluates children while breeding others.
+ *
+ * The steady-state algorithms evaluate the two children of a generation
+ * before the next selection, so every generation waits for its slowest
+ * evaluation. Here the calling thread breeds children with the operators of
+ * a steady-state GeneticAlgorithm and keeps a bounded queue of them filled,
+ * while worker threads evaluate them concurrently. Every child is inserted as
+ * soon as its fitness arrives, with the rule of competitive replacement: it
+ * takes the place of the worst individual if it is better.
+ *
+ * Selection and insertion only happen on the calling thread, so the
+ * population needs no locking and the random generator is only used there.
+ * With a single worker the children finish in the order they were bred and a
+ * run is reproducible; with more, they are inserted in the order they finish.
+ */
+class AsyncSGA : public Algorithm {
+public:
+    static constexpr size_t CHILDREN_PER_WORKER = 2; /**< Queued children per worker when no capacity is given. */
+
+protected:
+    std::shared_ptr<Evaluation> eval;
+    std::shared_ptr<GeneticAlgorithm> ga;
+    size_t maxEvaluations;
+    size_t numWorkers;
+    size_t queueCapacity;
+
+public:
+    /**
+     * @brief Constructor for AsyncSGA.
+     *
+     * @param eval A shared pointer to the Evaluation object used for fitness evaluation.
+     * @param ga The steady-state genetic algorithm whose population and operators are used.
+     * @param maxEvaluations The maximum number of evaluations.
+     * @param numWorkers The number of evaluation threads, 0 for the number of OpenMP threads.
+     * @param queueCapacity The maximum number of children bred and not yet inserted, 0 for CHILDREN_PER_WORKER per worker.
+     */
+    AsyncSGA(std::shared_ptr<Evaluation> eval, std::shared_ptr<GeneticAlgorithm> ga, size_t maxEvaluations = 15000,
+             size_t numWorkers = 0, size_t queueCapacity = 0);
+
+    virtual ~AsyncSGA() {}
+
+    /**
+     * @brief Runs the algorithm on the given dataset.
+     *
+     * A fitness record is kept for every generation bred, as in GeneticAlgorithm::run.
+     *
+     * @param dataset The dataset to run the algorithm on.
+     * @return EvaluatedSolution The best solution found by the algorithm.
+     */
+    EvaluatedSolution run(const DataSet& dataset) override;
+};
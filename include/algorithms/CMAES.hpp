@@ -1,10 +1,13 @@
 #pragma once
 
 #include "algorithms/Algorithm.hpp"
+#include "PopulationMatrix.hpp"
 #include <Eigen/Dense>
 
 class CMAES : public Algorithm {
 private:
+    using RowMajorMatrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
     std::shared_ptr<Evaluation> eval;
     size_t maxEvaluations;
     size_t lambda;                // Population size
@@ -19,10 +22,10 @@ private:
     float chiN;                   // Expectation of ||N(0,I)||
 
     void initializeParameters(size_t dimension);
-    std::vector<Solution> generatePopulation(const Eigen::VectorXf& mean, 
-                                           float sigma,
-                                           const Eigen::MatrixXf& C,
-                                           size_t dimension);
+    PopulationMatrix generatePopulation(const Eigen::VectorXf& mean, 
+                                        float sigma,
+                                        const Eigen::MatrixXf& C,
+                                        size_t dimension);
     std::vector<size_t> getSortedIndices(const std::vector<float>& fitness);
 
 public:
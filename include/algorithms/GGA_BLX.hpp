@@ -39,25 +39,25 @@ public:
      * @brief Selects individuals for reproduction using tournament selection.
      * 
      * @param population The current population.
-     * @return A vector of selected individuals.
+     * @return The rows of the selected individuals.
      */
-    std::vector<Solution> select_for_reproduction(const std::vector<Solution>& population) override;
+    std::vector<size_t> select_for_reproduction(const PopulationMatrix& population) override;
 
     /**
      * @brief Mutates the population by applying random changes to the solutions.
      * 
-     * @param population The current population.
-     * @return A vector of mutated individuals.
+     * @param population The population to mutate in place.
      */
-    std::vector<Solution> mutate_population(const std::vector<Solution>& population) override;
+    void mutate_population(PopulationMatrix& population) override;
 
     /**
      * @brief Recombines the population using the BLX crossover operator.
      * 
      * @param population The current population.
-     * @return A vector of recombined individuals.
+     * @param parents The rows of the selected individuals.
+     * @param offspring The recombined individuals.
      */
-    std::vector<Solution> recombine_population(const std::vector<Solution>& population) override;
+    void recombine_population(const PopulationMatrix& population, const std::vector<size_t>& parents, PopulationMatrix& offspring) override;
 
     /**
      * @brief Replaces the current population with the new population.
@@ -66,5 +66,5 @@ public:
      * @param newPopulation The new population.
      * @param dataset The dataset used for replacement.
      */
-    void replace_population(std::vector<Solution>& population, std::vector<Solution>& newPopulation, const DataSet& dataset) override;
+    void replace_population(PopulationMatrix& population, PopulationMatrix& newPopulation, const DataSet& dataset) override;
 };
\ No newline at end of file
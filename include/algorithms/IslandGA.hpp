@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "algorithms/Algorithm.hpp"
+#include "algorithms/GA.hpp"
+#include "Evaluation.hpp"
+
+/**
+ * @class IslandGA
+ * @brief An island-model genetic algorithm that evolves several populations in parallel.
+ *
+ * Every island is a GeneticAlgorithm with its own population, run on its own
+ * thread with its own random generator, seeded from the shared one. Every
+ * migrationInterval generations, each island sends copies of its best
+ * individuals to another island, which puts them in place of its worst ones
+ * when they are better. With the ring topology island i always sends to
+ * island i + 1; with the random topology the offset changes every migration,
+ * drawn from a generator shared by all the islands, so every island still
+ * receives from exactly one other.
+ *
+ * The evaluation budget is split evenly between the islands up front, and the
+ * threads exchange migrants through lock-free mailboxes tagged with the
+ * migration number, where an island waits for the migrants of its source.
+ * The result of a run therefore depends only on the seed and the parameters,
+ * not on the scheduling of the threads. The OpenMP threads are shared out
+ * between the islands for their evaluations.
+ */
+class IslandGA : public Algorithm {
+public:
+    /**
+     * @brief The islands every island sends its migrants to.
+     */
+    enum class Topology {
+        Ring, /**< Island i sends to island i + 1. */
+        Random /**< Island i sends to island i + 1 + r, with r drawn anew for every migration. */
+    };
+
+    static constexpr size_t DEFAULT_MIGRATION_INTERVAL = 10; /**< Generations between migrations. */
+    static constexpr size_t DEFAULT_MIGRANTS = 2; /**< Individuals sent by every island in a migration. */
+
+protected:
+    std::shared_ptr<Evaluation> eval;
+    std::vector<std::shared_ptr<GeneticAlgorithm>> islands;
+    size_t maxEvaluations;
+    size_t migrationInterval;
+    size_t numMigrants;
+    Topology topology;
+
+public:
+    /**
+     * @brief Constructor for IslandGA.
+     *
+     * @param eval A shared pointer to the Evaluation object used for fitness evaluation.
+     * @param islands The genetic algorithm of every island, each with its own state.
+     * @param maxEvaluations The maximum number of evaluations of all the islands together.
+     * @param migrationInterval The number of generations between migrations.
+     * @param numMigrants The number of individuals every island sends in a migration.
+     * @param topology The islands the migrants are sent to.
+     */
+    IslandGA(std::shared_ptr<Evaluation> eval, std::vector<std::shared_ptr<GeneticAlgorithm>> islands,
+             size_t maxEvaluations = 15000, size_t migrationInterval = DEFAULT_MIGRATION_INTERVAL,
+             size_t numMigrants = DEFAULT_MIGRANTS, Topology topology = Topology::Ring);
+
+    virtual ~IslandGA() {}
+
+    /**
+     * @brief Runs every island on its own thread until the budget is spent.
+     *
+     * The fitness record of every generation is the best fitness of all the islands.
+     *
+     * @param dataset The dataset to run the algorithm on.
+     * @return EvaluatedSolution The best solution of all the islands.
+     */
+    EvaluatedSolution run(const DataSet& dataset) override;
+};
@@ -25,22 +25,29 @@ public:
      */
     size_t getK() const;
 
+    /**
+     * Returns the training dataset, whose class table defines the meaning of the predicted ClassIds.
+     * 
+     * @return A const reference to the training dataset.
+     */
+    const DataSet& getTrainingData() const { return trainingData; }
+
     /**
      * Classifies a test item using the k-nearest neighbors algorithm.
      * 
-     * @param testItem The test item to classify.
+     * @param testRow The test row to classify.
      * @param weights The weights of the features.
-     * @return std::string The predicted label.
+     * @return ClassId The predicted class, as an identifier of the training dataset.
      */
-    virtual std::string classify(const DataItem& testItem, const Solution& weights) const;
+    virtual ClassId classify(const DataRow& testRow, const Solution& weights) const;
 
     /**
      * Classifies a test item using the k-nearest neighbors algorithm, excluding the feature at the given index.
      * 
-     * @param testItem The test item to classify.
+     * @param testRow The test row to classify.
      * @param excludeIndex The index of the feature to exclude.
      * @param solution The solution containing the weights of the features.
-     * @return The predicted label.
+     * @return The predicted class, as an identifier of the training dataset.
      */
-    virtual std::string classifyExcludingIndex(const DataItem& testItem, size_t excludeIndex, const Solution& solution);
+    virtual ClassId classifyExcludingIndex(const DataRow& testRow, size_t excludeIndex, const Solution& solution);
 };
@@ -1,6 +1,9 @@
 #pragma once
 #include "algorithms/Algorithm.hpp"
 #include "Evaluation.hpp"
+#include "IncrementalEvaluator.hpp"
+
+#include <memory>
 
 /**
  * @brief The LocalSearch class represents a local search algorithm.
@@ -28,6 +31,18 @@ protected:
     size_t maxEvaluations; /**< The maximum number of evaluations to perform. */
     float mean; /**< The mean value used for generating random values. */
     float std; /**< The standard deviation used for generating random values. */
+    std::unique_ptr<IncrementalEvaluator> incremental; /**< Scores single-weight neighbors without a full leave-one-out pass. */
+
+    /**
+     * @brief Builds the incremental evaluator of one run on the given dataset.
+     * 
+     * A new evaluator is built for every run, so a run never sees the distances
+     * of another dataset, even one that took the place of an earlier one in memory.
+     * 
+     * @param dataset The dataset on which the solutions will be evaluated.
+     * @return The incremental evaluator bound to the dataset.
+     */
+    IncrementalEvaluator& incrementalFor(const DataSet& dataset);
     
 public:
     /**
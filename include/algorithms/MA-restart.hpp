@@ -36,10 +36,9 @@ public:
     EvaluatedSolution run(const DataSet& dataset) override;
 
     /**
-     * @brief Calculates the variance of a population.
+     * @brief Calculates the mean variance of the weights of a population.
      * @param population The population to calculate the variance for.
-     * @param i The index of the solution in the population.
-     * @return The variance of the population.
+     * @return The population variance of every weight, averaged over the weights.
      */
-    float calculateVariance(const std::vector<Solution>& population, size_t i);
+    float calculateVariance(const PopulationMatrix& population);
 };
@@ -22,7 +22,6 @@ protected:
     std::shared_ptr<Evaluation> eval;
     std::shared_ptr<GeneticAlgorithm> ga;
     std::shared_ptr<LocalSearch> ls;
-    std::vector<float> populationFitness;
     size_t maxEvaluations;
     size_t optimizationFrequency;
     float elitismRate;
@@ -46,12 +45,15 @@ public:
     virtual ~MemeticAlgorithm();
 
     /**
-     * @brief Runs the memetic algorithm on a given dataset.
+     * @brief Optimizes part of the population with the local search, in place.
+     * 
+     * The individuals are ranked by the fitness stored in the population, and
+     * the fitness found by the local search is stored back with them.
      * 
+     * @param population The population to optimize.
      * @param dataset The dataset to optimize.
-     * @return std::vector<Solution> The optimized population of solutions.
      */
-    void optimize_population(std::vector<Solution>& population, const DataSet& dataset);
+    void optimize_population(PopulationMatrix& population, const DataSet& dataset);
 
     /**
      * @brief Runs the memetic algorithm on a given dataset.
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "algorithms/Algorithm.hpp"
+#include "IncrementalEvaluator.hpp"
 
 #include <memory>
 
@@ -11,14 +12,27 @@ private:
     float finalTemperature;
     float acceptanceProbability;
     float worseningProbability;
+    std::unique_ptr<IncrementalEvaluator> incremental;
 
     /**
      * @brief Generates a neighbor of the given solution.
      * 
      * @param solution Solution to generate a neighbor from
+     * @param index Set to the index of the weight that was modified
      * @return The generated neighbor.
      */
-    Solution generateNeighbor(const Solution& solution);
+    Solution generateNeighbor(const Solution& solution, size_t& index);
+
+    /**
+     * @brief Builds the incremental evaluator of one run on the given dataset.
+     * 
+     * A new evaluator is built for every run, so a run never sees the distances
+     * of another dataset, even one that took the place of an earlier one in memory.
+     * 
+     * @param dataset Dataset on which the solutions will be evaluated
+     * @return The incremental evaluator bound to the dataset.
+     */
+    IncrementalEvaluator& incrementalFor(const DataSet& dataset);
 
 public:
     /**
@@ -1,21 +1,120 @@
 #pragma once
 
 #include "data/DataSet.hpp"
+#include "utils/NpyArray.hpp"
 #include <string.h>
+#include <vector>
 
 /**
  * @brief Namespace for data loading operations.
  */
 namespace DataLoader {
+    constexpr size_t MIN_PARALLEL_CHUNK_BYTES = size_t(1) << 20; /**< Bytes of data rows per thread needed to parse in parallel. */
+    constexpr size_t NO_ROW = static_cast<size_t>(-1); /**< Marks that a row has no further occurrence. */
+
+    /**
+     * @brief The distinct rows of a dataset, with where and how often each one occurs.
+     */
+    struct UniqueRows {
+        DataSet rows; /**< Every distinct (features, class) row, in order of first occurrence, with the class table of the source. */
+        std::vector<uint32_t> counts; /**< The number of rows of the source equal to each distinct row. */
+        std::vector<size_t> firstOccurrences; /**< The index in the source of the first copy of each distinct row. */
+        std::vector<size_t> secondOccurrences; /**< The index in the source of the second copy of each distinct row, or NO_ROW. */
+    };
+
     /**
      * @brief Reads an ARFF file and populates a DataSet object.
      * 
+     * The data section is split into newline-aligned chunks parsed in
+     * parallel and appended in file order. Class labels must be declared in
+     * the header. The feature bounds of the dataset are extended to the rows
+     * read, so they cover every row added by the readers.
+     * 
+     * A data section whose rows are written as "{index value, ...}" is read
+     * as sparse ARFF into a sparse dataset. Omitted features are zero and an
+     * omitted class is the first one declared.
+     * 
+     * A gzip-compressed file, recognized by its first bytes, is decompressed
+     * on a background thread and parsed segment by segment as it arrives,
+     * without writing the decompressed text anywhere.
+     * 
      * @param filename The path to the ARFF file.
      * @param dataset The DataSet object to populate.
      * @return True if the file was successfully read and the DataSet was populated, false otherwise.
      */
     bool readARFF(const std::string& filename, DataSet& dataset);
 
+    /**
+     * @brief Reads a CSV file and populates a DataSet object.
+     * 
+     * Every row holds the features followed by the class label. A first row
+     * whose first value is not a number is taken as a header and skipped.
+     * Class labels are discovered in order of first appearance. Rows are
+     * parsed in parallel and the feature bounds updated as in readARFF, and
+     * gzip-compressed files are streamed as in readARFF.
+     * 
+     * @param filename The path to the CSV file.
+     * @param dataset The DataSet object to populate.
+     * @return True if the file was successfully read and the DataSet was populated, false otherwise.
+     */
+    bool readCSV(const std::string& filename, DataSet& dataset);
+
+    /**
+     * @brief Reads a libsvm file and populates a sparse DataSet object.
+     * 
+     * Every row holds the class label followed by "index:value" pairs with
+     * 1-based feature indices. The number of features grows to the highest
+     * index seen, and class labels are discovered as in readCSV.
+     * gzip-compressed files are streamed as in readARFF.
+     * 
+     * @param filename The path to the libsvm file.
+     * @param dataset The DataSet object to populate.
+     * @return True if the file was successfully read and the DataSet was populated, false otherwise.
+     */
+    bool readLibSVM(const std::string& filename, DataSet& dataset);
+
+    /**
+     * @brief Reads a CSV file if its name ends in .csv, a libsvm file if it ends in .libsvm or .svm, and an ARFF file otherwise.
+     * 
+     * A trailing .gz is ignored when choosing the format.
+     * 
+     * @param filename The path to the file.
+     * @param dataset The DataSet object to populate.
+     * @return True if the file was successfully read and the DataSet was populated, false otherwise.
+     */
+    bool readFile(const std::string& filename, DataSet& dataset);
+
+    /**
+     * @brief Reads a NumPy feature matrix and its labels and populates a DataSet object.
+     * 
+     * The features are a float32 or float64 array with one row per instance.
+     * float32 rows in C order are copied straight from the mapped array, and
+     * other layouts are converted value by value. Labels may be integers,
+     * booleans or strings, and classes are discovered as in readCSV. Rows with
+     * a NaN or infinite value are skipped, and the feature bounds are updated
+     * as in readARFF.
+     * 
+     * @param features The feature matrix.
+     * @param labels The label of every row.
+     * @param dataset The DataSet object to populate.
+     * @param rowOrder The rows to read, in order, or an empty vector to read every row in array order.
+     * @return True if the arrays have matching shapes and were read, false otherwise.
+     */
+    bool readNumpy(const NpyArray& features, const NpyArray& labels, DataSet& dataset,
+                   const std::vector<size_t>& rowOrder = {});
+
+    /**
+     * @brief Finds the minimum and maximum feature values of a dataset in a single pass.
+     * 
+     * The loaders already find the bounds while parsing, so this is only
+     * needed for datasets built in other ways.
+     * 
+     * @param dataset The dataset to inspect.
+     * @param minFeatureValues Set to the minimum value of every feature, empty for an empty dataset.
+     * @param maxFeatureValues Set to the maximum value of every feature, empty for an empty dataset.
+     */
+    void findFeatureBounds(const DataSet& dataset, DataItem& minFeatureValues, DataItem& maxFeatureValues);
+
     /**
      * @brief Finds the minimum feature values in a dataset.
      * 
@@ -32,12 +131,41 @@ namespace DataLoader {
      */
     DataItem findMaxFeatureValues(const DataSet& dataset);
 
+    /**
+     * @brief Finds the features that take the same value in every instance of a dataset.
+     * 
+     * Such features add the same amount to the distance from a query to every
+     * instance, so they never change which instance is the nearest one.
+     * 
+     * @param dataset The dataset to inspect.
+     * @return For every feature, whether it is constant across the dataset.
+     */
+    std::vector<bool> findConstantFeatures(const DataSet& dataset);
+
     /**
      * @brief Normalizes the features of a dataset.
      * 
+     * Dense rows are scaled to [0, 1] in one branch-free pass over the
+     * padded rows, split across threads for large datasets; constant
+     * features and the row padding become zero. Sparse values are only
+     * divided by the range, so zeros stay implicit.
+     * 
      * @param dataset The dataset to normalize.
      * @param minFeatureValues The minimum feature values.
      * @param maxFeatureValues The maximum feature values.
      */
     void normalizeFeatures(DataSet& dataset, const DataItem& minFeatureValues, const DataItem& maxFeatureValues);
+
+    /**
+     * @brief Collapses the identical rows of a normalized dense dataset.
+     * 
+     * Two rows are identical when every feature has the same bit pattern and
+     * they have the same class. The distinct rows keep the order of their
+     * first occurrence, so a nearest neighbor search over them resolves ties
+     * between different rows as it would over the whole dataset.
+     * 
+     * @param dataset The dataset to deduplicate.
+     * @return The distinct rows with their multiplicities and positions.
+     */
+    UniqueRows deduplicate(const DataSet& dataset);
 }
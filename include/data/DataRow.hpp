@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Lightweight, non-owning view of the features of one row of a DataSet.
+ *
+ * The view points straight into the contiguous feature buffer of the dataset,
+ * so it is cheap to copy and must not outlive the dataset it was taken from.
+ */
+struct DataRow {
+    const float* features; /**< Pointer to the first feature of the row. */
+    size_t numFeatures; /**< The number of features in the row. */
+
+    /**
+     * @brief Constructor for DataRow.
+     * @param features Pointer to the first feature of the row.
+     * @param numFeatures The number of features in the row.
+     */
+    DataRow(const float* features, size_t numFeatures)
+        : features(features), numFeatures(numFeatures) {}
+
+    /**
+     * @brief Returns the number of features in the row.
+     * @return The number of features.
+     */
+    size_t size() const { return numFeatures; }
+
+    /**
+     * @brief Accesses the feature at the specified index.
+     * @param index The index of the feature.
+     * @return The feature value.
+     */
+    float operator[](size_t index) const { return features[index]; }
+
+    const float* begin() const { return features; }
+    const float* end() const { return features + numFeatures; }
+};
@@ -1,30 +1,199 @@
 #pragma once
 #include "data/DataItem.hpp"
-#include <set>
+#include "data/DataRow.hpp"
+#include "data/SparseRow.hpp"
+#include "utils/AlignedAllocator.hpp"
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
 #include <iostream>
 
+/**
+ * @brief Dense integer identifier of a class label within a DataSet.
+ */
+using ClassId = uint16_t;
+
 /**
  * @class DataSet
  * @brief Represents a collection of data items.
+ *
+ * The features of all rows are stored in a single row-major buffer. Every row
+ * starts on a ROW_ALIGNMENT boundary and occupies getStride() floats, the
+ * trailing padding being zero. Labels are interned into a dense table of class
+ * names and every row only stores its ClassId; the names are only needed again
+ * when results are printed.
+ *
+ * A sparse dataset stores its rows in compressed sparse row form instead:
+ * the indices and values of the non-zero features of every row, one row after
+ * the other. Its rows are read with sparseRow() and have no dense view, so
+ * datasets with many mostly-zero features fit in memory.
+ *
+ * A dataset can also be a view over rows it does not own: a range of rows of
+ * another dataset, all its rows but one range, or external buffers with the
+ * same layout. A view shares the rows of its source instead of copying them,
+ * so it is read-only and must not outlive the source or any change to its
+ * rows.
  */
 class DataSet {
 public:
-    std::vector<DataItem> items; /**< The vector of data items in the dataset. */
-    std::set<std::string> uniqueClasses; /**< The set of unique class labels in the dataset. */
+    static constexpr size_t ROW_ALIGNMENT = 64; /**< Alignment in bytes of every row. */
+    static constexpr ClassId NO_CLASS = std::numeric_limits<ClassId>::max(); /**< Marks a missing or unknown class. */
+    static constexpr size_t NO_GAP = std::numeric_limits<size_t>::max(); /**< Marks that a dataset leaves no rows out. */
+
     DataItem minFeatureValue; /**< The minimum feature value in the dataset. */
     DataItem maxFeatureValue; /**< The maximum feature value in the dataset. */
 
+private:
+    std::vector<float, AlignedAllocator<float, ROW_ALIGNMENT>> features; /**< Row-major feature buffer. */
+    std::vector<ClassId> labels; /**< The class identifier of every row. */
+    std::vector<std::string> classNames; /**< The class label of every ClassId. */
+    std::unordered_map<std::string, ClassId> classIds; /**< The ClassId of every class label. */
+    size_t numFeatures; /**< The number of features per row. */
+    size_t stride; /**< The distance in floats between the start of two consecutive rows. */
+    const float* rowBase; /**< The first row, in features or in the source of a view. */
+    const ClassId* labelBase; /**< The label of the first row, in labels or in the source of a view. */
+    size_t numRows; /**< The number of rows. */
+    size_t gapRow; /**< The first row after a range of source rows left out of a view, or NO_GAP. */
+    size_t gapSize; /**< The number of source rows left out at gapRow. */
+    bool borrowed; /**< Whether the rows belong to another dataset. */
+
+    bool sparse; /**< Whether the rows are stored in compressed sparse row form. */
+    std::vector<size_t> rowOffsets; /**< The first stored value of every row, plus the total, when sparse. */
+    std::vector<uint32_t> sparseIndices; /**< The feature index of every stored value when sparse. */
+    std::vector<float> sparseValues; /**< The stored values when sparse. */
+    const size_t* offsetBase; /**< The offset of the first row, in rowOffsets or in the source of a view. */
+    const uint32_t* indexBase; /**< The first stored index, in sparseIndices or in the source of a view. */
+    const float* valueBase; /**< The first stored value, in sparseValues or in the source of a view. */
+
+    /**
+     * @brief Points the row and label pointers back at the owned buffers after they may have moved.
+     */
+    void rebind();
+
+public:
+
     /**
      * @brief Empty DataSet constructor.
      */
     DataSet();
 
+    DataSet(const DataSet& other);
+    DataSet(DataSet&& other) noexcept;
+    DataSet& operator=(const DataSet& other);
+    DataSet& operator=(DataSet&& other) noexcept;
+
+    /**
+     * @brief Creates a read-only view over consecutive rows of a dataset.
+     *
+     * The view shares the rows of the source and copies its class table, so
+     * its ClassIds are those of the source. The source must not leave rows
+     * out itself.
+     *
+     * @param source The dataset holding the rows.
+     * @param firstRow The index of the first row of the view.
+     * @param count The number of rows of the view.
+     * @return The view.
+     */
+    static DataSet view(const DataSet& source, size_t firstRow, size_t count);
+
+    /**
+     * @brief Creates a read-only view over every row of a dataset but a range.
+     *
+     * The rows keep their order. The source must not leave rows out itself.
+     *
+     * @param source The dataset holding the rows.
+     * @param firstExcluded The index of the first row left out.
+     * @param numExcluded The number of rows left out.
+     * @return The view.
+     */
+    static DataSet viewExcluding(const DataSet& source, size_t firstExcluded, size_t numExcluded);
+
+    /**
+     * @brief Creates a read-only view over external buffers laid out like the rows of a dataset.
+     *
+     * @param rows The first row, aligned to ROW_ALIGNMENT, rows being padded to the stride of numFeatures.
+     * @param labels The ClassId of every row.
+     * @param numRows The number of rows.
+     * @param numFeatures The number of features per row.
+     * @param classNames The class label of every ClassId.
+     * @return The view.
+     */
+    static DataSet wrap(const float* rows, const ClassId* labels, size_t numRows, size_t numFeatures,
+                        const std::vector<std::string>& classNames);
+
+    /**
+     * @brief Returns the distance in floats between two rows for a number of features.
+     * @param numFeatures The number of features per row.
+     * @return The row stride.
+     */
+    static size_t strideFor(size_t numFeatures);
+
+    /**
+     * @brief Checks whether the dataset is a view over the rows of another one.
+     * @return True if the rows are not owned.
+     */
+    bool isView() const { return borrowed; }
+
     /**
      * @brief Returns the number of features in the dataset.
      * @return The number of features.
      */
     int getNumFeatures() const;
 
+    /**
+     * @brief Checks whether the rows are stored in compressed sparse row form.
+     * @return True for a sparse dataset.
+     */
+    bool isSparse() const { return sparse; }
+
+    /**
+     * @brief Turns an empty dataset into a sparse one.
+     * @param declaredFeatures The number of features, which grows if rows use higher indices.
+     */
+    void makeSparse(size_t declaredFeatures);
+
+    /**
+     * @brief Adds a row of a sparse dataset.
+     *
+     * Rows with an unknown class, with indices that do not increase, or added
+     * to a view or a dense dataset are rejected.
+     *
+     * @param indices The feature index of every non-zero value, in increasing order.
+     * @param values The non-zero values.
+     * @param count The number of non-zero values.
+     * @param classId The class identifier of the row.
+     */
+    void addSparseRow(const uint32_t* indices, const float* values, size_t count, ClassId classId);
+
+    /**
+     * @brief Returns the non-zero features of a row of a sparse dataset.
+     * @param index The index of the row.
+     * @return A view into the compressed rows.
+     */
+    SparseRow sparseRow(size_t index) const {
+        size_t source = sourceIndex(index);
+        size_t first = offsetBase[source];
+        return SparseRow(indexBase + first, valueBase + first, offsetBase[source + 1] - first);
+    }
+
+    /**
+     * @brief Returns the stored values of a sparse dataset that owns its rows, to modify them.
+     * @return Pointer to the values of every row, one row after the other.
+     */
+    float* sparseValueData() { return sparseValues.data(); }
+
+    /**
+     * @brief Returns the number of stored values of a sparse dataset that owns its rows.
+     * @return The number of non-zero features of all rows.
+     */
+    size_t getNumStoredValues() const { return sparseValues.size(); }
+
+    /**
+     * @brief Returns the distance in floats between two consecutive rows.
+     * @return The row stride.
+     */
+    size_t getStride() const { return stride; }
+
     /**
      * @brief Sets the maximum feature value in the dataset.
      * @param maxFeatureValue The maximum feature value.
@@ -51,10 +220,33 @@ public:
 
     /**
      * @brief Adds a data item to the dataset.
+     *
+     * The features are copied into the contiguous buffer. The first item fixes
+     * the number of features; items of a different length are rejected, as are
+     * items added to a view.
+     *
      * @param item The data item to be added.
      */
     void addItem(const DataItem& item);
 
+    /**
+     * @brief Adds a row whose label has already been interned.
+     *
+     * The first row fixes the number of features; rows of a different length
+     * or with an unknown class, and rows added to a view, are rejected.
+     *
+     * @param rowFeatures Pointer to the features of the row.
+     * @param rowSize The number of features of the row.
+     * @param classId The class identifier of the row.
+     */
+    void addRow(const float* rowFeatures, size_t rowSize, ClassId classId);
+
+    /**
+     * @brief Reserves storage for the given number of rows.
+     * @param count The number of rows.
+     */
+    void reserve(size_t count);
+
     /**
      * @brief Adds a dataset to the current dataset.
      * @param dataset The dataset to be added.
@@ -69,9 +261,41 @@ public:
 
     /**
      * @brief Adds a class label to the dataset.
+     *
+     * Labels are interned in insertion order, so the first label declared gets
+     * ClassId 0. Adding an existing label has no effect.
+     *
      * @param classLabel The class label to be added.
+     * @return The ClassId of the label.
+     */
+    ClassId addClassLabel(const std::string& classLabel);
+
+    /**
+     * @brief Returns the ClassId of a class label.
+     * @param classLabel The class label.
+     * @return The ClassId, or NO_CLASS if the label is unknown.
      */
-    void addClassLabel(const std::string& classLabel);
+    ClassId getClassId(const std::string& classLabel) const;
+
+    /**
+     * @brief Returns the class label of a ClassId.
+     * @param classId The class identifier.
+     * @return A const reference to the class label.
+     */
+    const std::string& getClassName(ClassId classId) const;
+
+    /**
+     * @brief Returns the number of distinct classes declared in the dataset.
+     * @return The number of classes.
+     */
+    size_t getNumClasses() const { return classNames.size(); }
+
+    /**
+     * @brief Maps every ClassId of this dataset to the ClassId of the same label in another dataset.
+     * @param reference The dataset whose class table is the target of the mapping.
+     * @return A vector indexed by this dataset's ClassId, holding NO_CLASS for labels unknown to the reference.
+     */
+    std::vector<ClassId> mapClassIds(const DataSet& reference) const;
 
     /**
      * @brief Checks if a class label exists in the dataset.
@@ -80,24 +304,84 @@ public:
      */
     bool classLabelExists(const std::string& classLabel) const;
 
+    /**
+     * @brief Checks whether two datasets read the very same rows, as a view and its source or two views over the same range do.
+     *
+     * The rows are compared by where they are stored, so the check takes
+     * constant time. A copy of a dataset that owns its rows has rows of its
+     * own and does not share them. Since views require the rows of their
+     * source to stay unchanged, a match means equal contents for as long as
+     * that holds.
+     *
+     * @param other The dataset to compare with.
+     * @return True if both datasets read the same rows and labels of the same storage.
+     */
+    bool sharesRowsWith(const DataSet& other) const;
+
     /**
      * @brief Clears the dataset.
      */
     void clear();
 
     /**
-     * @brief Accesses the data item at the specified index.
-     * @param index The index of the data item.
-     * @return A reference to the data item.
+     * @brief Returns a view of the features of the row at the specified index.
+     *
+     * Only dense datasets have dense rows.
+     *
+     * @param index The index of the row.
+     * @return A view into the feature buffer.
+     */
+    DataRow row(size_t index) const {
+        return DataRow(rowBase + sourceIndex(index) * stride, numFeatures);
+    }
+
+    /**
+     * @brief Returns the position of a row among the rows of the source of the dataset.
+     * @param index The index of the row.
+     * @return The index past any rows left out.
+     */
+    size_t sourceIndex(size_t index) const {
+        return index >= gapRow ? index + gapSize : index;
+    }
+
+    /**
+     * @brief Returns a mutable pointer to the features of the row at the specified index.
+     *
+     * Only datasets that own their rows can be modified, not views.
+     *
+     * @param index The index of the row.
+     * @return Pointer to the first feature of the row.
+     */
+    float* rowData(size_t index) {
+        return features.data() + index * stride;
+    }
+
+    /**
+     * @brief Returns the class identifier of the row at the specified index.
+     * @param index The index of the row.
+     * @return The ClassId of the row.
      */
-    DataItem& operator[](int index);
+    ClassId getClassId(size_t index) const {
+        return labelBase[sourceIndex(index)];
+    }
 
     /**
-     * @brief Accesses the data item at the specified index (const version).
-     * @param index The index of the data item.
-     * @return A const reference to the data item.
+     * @brief Returns the class label of the row at the specified index.
+     * @param index The index of the row.
+     * @return A const reference to the label.
      */
-    const DataItem& operator[](int index) const;
+    const std::string& getLabel(size_t index) const {
+        return classNames[labelBase[sourceIndex(index)]];
+    }
+
+    /**
+     * @brief Accesses the row at the specified index.
+     * @param index The index of the row.
+     * @return A view into the feature buffer.
+     */
+    DataRow operator[](size_t index) const {
+        return row(index);
+    }
 
     /**
      * @brief Operator overload for the output stream.
@@ -115,16 +399,30 @@ public:
  * @return The output stream.
  */
 inline std::ostream& operator<<(std::ostream& os, const DataSet& dataset) {
-    for (const auto& item : dataset.items) {
-        // Explicit stream for DataItem
+    for (size_t r = 0; r < dataset.size(); ++r) {
+        if (dataset.isSparse()) {
+            SparseRow row = dataset.sparseRow(r);
+            os << "DataItem: " << "{{";
+            for (size_t i = 0; i < row.size(); ++i) {
+                os << row.indices[i] << " " << row.values[i];
+                if (i < row.size() - 1) {
+                    os << ", ";
+                }
+            }
+            os << "}, " << dataset.getLabel(r) << "}" << std::endl;
+            continue;
+        }
+
+        // Explicit stream for every row
+        DataRow row = dataset.row(r);
         os << "DataItem: " << "{[";
-        for (size_t i = 0; i < item.features.size(); ++i) {
-            os << item.features[i];
-            if (i < item.features.size() - 1) {
+        for (size_t i = 0; i < row.size(); ++i) {
+            os << row[i];
+            if (i < row.size() - 1) {
                 os << ", ";
             }
         }
-        os << "], " << item.label << "}" << std::endl;
+        os << "], " << dataset.getLabel(r) << "}" << std::endl;
     }
     return os;
 }
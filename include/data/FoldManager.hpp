@@ -0,0 +1,188 @@
+#pragma once
+
+#include "data/DataSet.hpp"
+#include "utils/MappedFile.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class FoldManager
+ * @brief Holds the partitions of a cross-validation and serves the folds as views.
+ *
+ * Every partition file is parsed once into a single dataset, in file order.
+ * A fold uses one partition as test set and all the others as training set,
+ * and both are handed out as zero-copy views of the shared rows.
+ *
+ * The normalized partitions can be saved to a binary cache and memory-mapped
+ * on later runs instead of parsing the text files again. The cache file holds,
+ * after a CacheHeader: the first row of every partition as uint64 values plus
+ * the total, the minimum and maximum raw value of every feature as float32,
+ * the class dictionary as a uint32 length and the bytes of every label, then,
+ * aligned to DataSet::ROW_ALIGNMENT, the float32 feature block with the
+ * padded row stride of DataSet, and the uint16 ClassId of every row. The
+ * header records a hash of the contents of the source files, so a cache built
+ * from other files is rebuilt. Sparse datasets are always parsed, since the
+ * cache only holds dense rows.
+ *
+ * Instead of one file per partition, the partitions can come from NumPy
+ * arrays: a float feature matrix, a label vector and an integer fold vector,
+ * either as the members features, labels and folds of a .npz archive or as
+ * the files PREFIX_features.npy, PREFIX_labels.npy and PREFIX_folds.npy.
+ * Every distinct fold value is a partition, in increasing order. The arrays
+ * are read in place from their mappings, and the normalized rows are cached
+ * like parsed ones, so later runs map the cache instead.
+ */
+class FoldManager {
+public:
+    static constexpr uint32_t CACHE_VERSION = 1; /**< The version of the cache file format. */
+    static constexpr const char* NUMPY_FEATURES_SUFFIX = "_features.npy"; /**< The suffix of a NumPy feature matrix file. */
+    static constexpr const char* NUMPY_LABELS_SUFFIX = "_labels.npy"; /**< The suffix of its label vector file. */
+    static constexpr const char* NUMPY_FOLDS_SUFFIX = "_folds.npy"; /**< The suffix of its fold vector file. */
+
+    /**
+     * @brief The fixed-size header at the start of a cache file.
+     */
+    struct CacheHeader {
+        char magic[8]; /**< Identifies a cache file. */
+        uint32_t version; /**< The CACHE_VERSION the file was written with. */
+        uint32_t byteOrder; /**< A known value, to reject files written with another byte order. */
+        uint64_t contentHash; /**< The hash of the source files. */
+        uint64_t numRows; /**< The number of rows of all partitions. */
+        uint64_t numFeatures; /**< The number of features per row. */
+        uint64_t numPartitions; /**< The number of partitions. */
+        uint64_t numClasses; /**< The number of entries of the class dictionary. */
+        uint64_t partitionsOffset; /**< The offset of the first row of every partition. */
+        uint64_t boundsOffset; /**< The offset of the feature bounds. */
+        uint64_t classesOffset; /**< The offset of the class dictionary. */
+        uint64_t featuresOffset; /**< The offset of the feature block. */
+        uint64_t labelsOffset; /**< The offset of the label block. */
+        uint64_t fileSize; /**< The size of the whole file. */
+    };
+
+private:
+    DataSet storage; /**< The rows of every partition, owned or mapped from a cache. */
+    std::vector<size_t> partitionSizes; /**< The number of rows of every partition. */
+    std::unique_ptr<MappedFile> cache; /**< The mapped cache the storage points into, if any. */
+
+    /**
+     * @brief Returns the first row of a partition.
+     * @param partition The index of the partition.
+     * @return The index of its first row.
+     */
+    size_t partitionStart(size_t partition) const;
+
+    /**
+     * @brief Parses the partition files into the storage and normalizes it.
+     * @param filenames The data file of every partition, or a single NumPy source.
+     * @return True if every file was read.
+     */
+    bool parse(const std::vector<std::string>& filenames);
+
+    /**
+     * @brief Reads the partitions from NumPy arrays into the storage and normalizes it.
+     * @param source A .npz archive, or a PREFIX_features.npy file with its companion arrays.
+     * @return True if every array was read.
+     */
+    bool parseNumpy(const std::string& source);
+
+    /**
+     * @brief Normalizes the features of every fold.
+     *
+     * A fold is normalized with the bounds of its training and test sets
+     * together, which cover every partition, so all the rows are normalized
+     * once with the bounds of the whole storage, as found by the loaders.
+     */
+    void normalize();
+
+    /**
+     * @brief Maps a cache file and points the storage into it.
+     * @param cachePath The path of the cache file.
+     * @param contentHash The hash of the source files the cache must have been built from.
+     * @return True if the cache is valid and was mapped.
+     */
+    bool readCache(const std::string& cachePath, uint64_t contentHash);
+
+    /**
+     * @brief Writes the storage to a cache file.
+     *
+     * The file is written under a temporary name and renamed, so concurrent
+     * runs never map a partial cache.
+     *
+     * @param cachePath The path of the cache file.
+     * @param contentHash The hash of the source files.
+     * @return True if the cache was written.
+     */
+    bool writeCache(const std::string& cachePath, uint64_t contentHash) const;
+
+    /**
+     * @brief Hashes the contents of the partition files.
+     * @param filenames The data file of every partition, or a single NumPy source.
+     * @return The hash, which also reflects missing files.
+     */
+    static uint64_t hashFiles(const std::vector<std::string>& filenames);
+
+    /**
+     * @brief Checks whether the partitions come from NumPy arrays.
+     * @param filenames The files given to load.
+     * @return True for a single .npz archive or PREFIX_features.npy file.
+     */
+    static bool isNumpySource(const std::vector<std::string>& filenames);
+
+    /**
+     * @brief Lists every file the partitions are read from, NumPy companion arrays included.
+     * @param filenames The files given to load.
+     * @return The files whose contents make up the dataset.
+     */
+    static std::vector<std::string> sourceFiles(const std::vector<std::string>& filenames);
+
+public:
+    /**
+     * @brief Reads and normalizes every partition of a cross-validation.
+     *
+     * When a cache path is given, a valid cache built from the same files is
+     * mapped instead of parsing them, and otherwise a new cache is written
+     * after parsing. A file that cannot be read leaves its partition empty,
+     * and no cache is written then.
+     *
+     * @param filenames The data file of every partition, in fold order, or a single NumPy source.
+     * @param cachePath The path of the binary cache, or an empty string to always parse.
+     * @return True if every file was read.
+     */
+    bool load(const std::vector<std::string>& filenames, const std::string& cachePath = "");
+
+    /**
+     * @brief Parses every partition of a cross-validation and writes its cache, even if one is valid.
+     * @param filenames The data file of every partition, in fold order, or a single NumPy source.
+     * @param cachePath The path of the binary cache.
+     * @return True if every file was read and the cache was written.
+     */
+    bool convert(const std::vector<std::string>& filenames, const std::string& cachePath);
+
+    /**
+     * @brief Returns the number of folds.
+     * @return The number of partitions loaded.
+     */
+    size_t getNumFolds() const { return partitionSizes.size(); }
+
+    /**
+     * @brief Checks whether the partitions were mapped from a cache.
+     * @return True if the rows live in a cache file.
+     */
+    bool isCached() const { return cache != nullptr; }
+
+    /**
+     * @brief Returns the training set of a fold.
+     * @param fold The index of the fold, that is, of its test partition.
+     * @return A view over the rows of every other partition, in file order.
+     */
+    DataSet getTrainingSet(size_t fold) const;
+
+    /**
+     * @brief Returns the test set of a fold.
+     * @param fold The index of the fold, that is, of its test partition.
+     * @return A view over the rows of the partition.
+     */
+    DataSet getTestSet(size_t fold) const;
+};
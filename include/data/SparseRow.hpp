@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lightweight, non-owning view of the non-zero features of one row of a sparse DataSet.
+ *
+ * The indices are strictly increasing and every feature not listed is zero.
+ * The view points straight into the compressed rows of the dataset, so it is
+ * cheap to copy and must not outlive the dataset it was taken from.
+ */
+struct SparseRow {
+    const uint32_t* indices; /**< The feature index of every stored value, in increasing order. */
+    const float* values; /**< The stored values. */
+    size_t numValues; /**< The number of stored values. */
+
+    /**
+     * @brief Constructor for SparseRow.
+     * @param indices The feature index of every stored value.
+     * @param values The stored values.
+     * @param numValues The number of stored values.
+     */
+    SparseRow(const uint32_t* indices, const float* values, size_t numValues)
+        : indices(indices), values(values), numValues(numValues) {}
+
+    /**
+     * @brief Returns the number of stored values.
+     * @return The number of non-zero features.
+     */
+    size_t size() const { return numValues; }
+};
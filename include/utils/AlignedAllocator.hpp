@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+/**
+ * @brief Minimal allocator that returns memory aligned to a fixed boundary.
+ *
+ * Used to back contiguous feature buffers so that every row starts on a
+ * cache line (and SIMD register) boundary.
+ *
+ * @tparam T The value type.
+ * @tparam Alignment The alignment in bytes. Must be a power of two.
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    /**
+     * @brief Allocates storage for n objects of type T.
+     *
+     * @param n The number of objects.
+     * @return Pointer to the aligned storage.
+     */
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    /**
+     * @brief Releases storage obtained from allocate.
+     *
+     * @param p Pointer to the storage.
+     * @param n The number of objects.
+     */
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
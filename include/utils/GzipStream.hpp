@@ -0,0 +1,83 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @class GzipStream
+ * @brief Decompresses a gzip file on a background thread.
+ *
+ * The file is inflated into blocks of about BLOCK_BYTES, handed over through
+ * a queue of at most MAX_QUEUED_BLOCKS blocks, so decompression overlaps with
+ * whatever the reader does with the previous blocks while memory stays
+ * bounded. Concatenated gzip members are read one after the other.
+ */
+class GzipStream {
+public:
+    static constexpr size_t BLOCK_BYTES = size_t(4) << 20; /**< The size in bytes of a decompressed block. */
+    static constexpr size_t MAX_QUEUED_BLOCKS = 4; /**< The number of blocks decompressed ahead of the reader. */
+
+private:
+    std::deque<std::string> blocks; /**< The decompressed blocks not yet taken by the reader. */
+    std::mutex mutex; /**< Guards the queue and the flags. */
+    std::condition_variable changed; /**< Signals a block added or taken, or the end of the stream. */
+    bool opened; /**< Whether the file could be opened. */
+    bool finished; /**< Whether the background thread is done. */
+    bool failed; /**< Whether the compressed data was corrupt or truncated. */
+    bool stopping; /**< Whether the reader has gone and decompression must stop. */
+    std::thread worker; /**< The thread that inflates the file. */
+
+    /**
+     * @brief Inflates the file into the queue until its end, an error or a stop request.
+     * @param file The gzFile handle, as an opaque pointer.
+     */
+    void decompress(void* file);
+
+public:
+    /**
+     * @brief Opens a gzip file and starts decompressing it.
+     * @param filename The path of the file.
+     */
+    explicit GzipStream(const std::string& filename);
+
+    /**
+     * @brief Stops decompressing and waits for the background thread.
+     */
+    ~GzipStream();
+
+    GzipStream(const GzipStream&) = delete;
+    GzipStream& operator=(const GzipStream&) = delete;
+
+    /**
+     * @brief Checks whether the file was opened.
+     * @return True if decompression started.
+     */
+    bool isOpen() const { return opened; }
+
+    /**
+     * @brief Waits for the next decompressed block.
+     * @param block Receives the block.
+     * @return False once the whole file has been read.
+     */
+    bool next(std::string& block);
+
+    /**
+     * @brief Checks whether decompression stopped on corrupt or truncated data.
+     *
+     * Only meaningful once next has returned false.
+     *
+     * @return True if the stream ended with an error.
+     */
+    bool hasFailed();
+
+    /**
+     * @brief Checks whether a buffer starts with the gzip magic bytes.
+     * @param data The first bytes of a file.
+     * @param size The number of bytes available.
+     * @return True for gzip data.
+     */
+    static bool isGzip(const char* data, size_t size);
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The contents are mapped into the address space on construction and
+ * unmapped on destruction, so they can be scanned in place without copying
+ * them into a buffer. An empty file is a valid, empty mapping.
+ */
+class MappedFile {
+private:
+    const char* contents; /**< The first byte of the mapping, or nullptr if nothing is mapped. */
+    size_t length; /**< The size of the file in bytes. */
+    bool opened; /**< Whether the file could be opened and mapped. */
+
+public:
+    /**
+     * @brief Maps a file into memory.
+     * @param filename The path of the file.
+     */
+    explicit MappedFile(const std::string& filename);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Checks whether the file was opened and mapped.
+     * @return True if the contents are available.
+     */
+    bool isOpen() const { return opened; }
+
+    /**
+     * @brief Returns the first byte of the file.
+     * @return Pointer to the contents, valid while the object lives.
+     */
+    const char* data() const { return contents; }
+
+    /**
+     * @brief Returns the size of the file.
+     * @return The number of bytes of the file.
+     */
+    size_t size() const { return length; }
+};
@@ -1,6 +1,8 @@
 #pragma once
+#include "data/SparseRow.hpp"
 #include <vector>
 #include <set>
+#include <cstddef>
 
 namespace MathUtils {
     /**
@@ -74,6 +76,62 @@ namespace MathUtils {
      * @return The calculated distance.
      */
     float weightedMinkowskiDistance(const std::vector<float>& v1, const std::vector<float>& v2, const std::vector<float>& weights, float p);
+    /**
+     * @brief Calculate the weighted Minkowski distance between two contiguous rows.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param weights Pointer to the weights to be used in the distance calculation.
+     * @param n The number of features.
+     * @param p The value of p to be used in the distance calculation.
+     * @return The calculated distance.
+     */
+    float weightedMinkowskiDistance(const float* v1, const float* v2, const float* weights, size_t n, float p);
+    /**
+     * @brief Calculate the weighted squared Euclidean distance between two contiguous rows.
+     * 
+     * Runs on the widest SIMD kernel supported by the CPU, selected once at startup.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param weights Pointer to the weights to be used in the distance calculation.
+     * @param n The number of features.
+     * @return The sum of weights[i] * (v1[i] - v2[i])^2.
+     */
+    float weightedSquaredEuclideanDistance(const float* v1, const float* v2, const float* weights, size_t n);
+    /**
+     * @brief Calculate the weighted squared Euclidean distance between two contiguous rows, giving up past a bound.
+     * 
+     * The features are added in blocks, in order, and the accumulation stops as
+     * soon as the running sum exceeds the bound. Visiting the heaviest weights
+     * first makes the bound bite early.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param weights Pointer to the weights to be used in the distance calculation.
+     * @param n The number of features.
+     * @param bound The distance beyond which the exact value is not needed.
+     * @return The exact distance if it does not exceed the bound, otherwise a partial sum greater than the bound.
+     */
+    float weightedSquaredEuclideanDistanceBounded(const float* v1, const float* v2, const float* weights, size_t n, float bound);
+    /**
+     * @brief Calculate the weighted Manhattan distance between two contiguous rows.
+     * 
+     * Runs on the widest SIMD kernel supported by the CPU, selected once at startup.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param weights Pointer to the weights to be used in the distance calculation.
+     * @param n The number of features.
+     * @return The sum of weights[i] * |v1[i] - v2[i]|.
+     */
+    float weightedManhattanDistance(const float* v1, const float* v2, const float* weights, size_t n);
+    /**
+     * @brief Get the name of the distance kernel set selected for this CPU.
+     * 
+     * @return One of "scalar", "sse4", "avx2" or "avx512".
+     */
+    const char* getDistanceKernelName();
     /**
      * @brief Calculate the mixed distance between two vectors.
      * 
@@ -104,6 +162,18 @@ namespace MathUtils {
      */
     float calculateDistance(const std::vector<float>& v1, const std::vector<float>& v2, const std::vector<float>& weights = {}, float p = 2.0f);
 
+    /**
+     * @brief Calculate the weighted Minkowski distance between two contiguous rows.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param weights Pointer to the weights to be used in the distance calculation.
+     * @param n The number of features.
+     * @param p The value of p to be used in the distance calculation.
+     * @return The calculated distance.
+     */
+    float calculateDistance(const float* v1, const float* v2, const float* weights, size_t n, float p = 2.0f);
+
     /**
      * @brief Calculate the distance between two vectors using weighted Euclidean distance.
      * 
@@ -114,6 +184,17 @@ namespace MathUtils {
      */
     float weightedEuclideanDistance(const std::vector<float>& v1, const std::vector<float>& v2, const std::vector<float>& weights);
 
+    /**
+     * @brief Calculate the weighted Euclidean distance between two contiguous rows.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param weights Pointer to the weights to be used in the distance calculation.
+     * @param n The number of features.
+     * @return The calculated distance.
+     */
+    float weightedEuclideanDistance(const float* v1, const float* v2, const float* weights, size_t n);
+
     /**
      * @brief Calculate the Euclidean distance between two vectors.
      * 
@@ -122,4 +203,39 @@ namespace MathUtils {
      * @return The calculated distance.
      */
     float euclideanDistance(const std::vector<float>& v1, const std::vector<float>& v2);
+
+    /**
+     * @brief Calculate the Euclidean distance between two contiguous rows.
+     * 
+     * @param v1 Pointer to the first row.
+     * @param v2 Pointer to the second row.
+     * @param n The number of features.
+     * @return The calculated distance.
+     */
+    float euclideanDistance(const float* v1, const float* v2, size_t n);
+
+    /**
+     * @brief Calculate the weighted squared norm of a sparse row.
+     * 
+     * @param row The non-zero features of the row.
+     * @param weights Pointer to the weights of every feature.
+     * @return The sum of weights[i] * row[i]^2.
+     */
+    float weightedSquaredNorm(const SparseRow& row, const float* weights);
+
+    /**
+     * @brief Calculate the weighted squared Euclidean distance between two sparse rows.
+     * 
+     * Uses |a - b|^2 = |a|^2 + |b|^2 - 2 a.b with the weighted norms computed
+     * beforehand, so only the features stored in both rows are visited, in a
+     * single merge of their sorted indices.
+     * 
+     * @param a The first row.
+     * @param b The second row.
+     * @param weights Pointer to the weights of every feature.
+     * @param normA The weighted squared norm of the first row.
+     * @param normB The weighted squared norm of the second row.
+     * @return The distance, clamped at zero against rounding.
+     */
+    float weightedSquaredEuclideanDistance(const SparseRow& a, const SparseRow& b, const float* weights, float normA, float normB);
 }
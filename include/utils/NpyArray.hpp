@@ -0,0 +1,117 @@
+#pragma once
+#include "utils/MappedFile.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @class NpyArray
+ * @brief Read-only NumPy array mapped from a .npy file or a member of a .npz archive.
+ *
+ * The header is parsed and the elements are read in place from the mapping,
+ * so a .npy file or an uncompressed .npz member is never copied. Members
+ * compressed with deflate, as written by numpy.savez_compressed, are inflated
+ * into memory once. Only little-endian numeric, boolean and string arrays are
+ * supported.
+ */
+class NpyArray {
+private:
+    std::unique_ptr<MappedFile> file; /**< The mapped .npy file or .npz archive. */
+    std::vector<char> inflated; /**< The member decompressed from the archive, if it was compressed. */
+    const char* elements; /**< The first element. */
+    char kind; /**< The NumPy type kind: 'f', 'i', 'u', 'b', 'U' or 'S'. */
+    size_t itemSize; /**< The size in bytes of one element. */
+    bool fortranOrder; /**< Whether the array is stored column by column. */
+    std::vector<size_t> shape; /**< The size of every dimension. */
+    std::string error; /**< Why the array could not be opened, empty if it was. */
+
+    /**
+     * @brief Parses the .npy header at the start of a buffer and points elements past it.
+     * @param data The start of the .npy contents.
+     * @param length The size in bytes of the .npy contents.
+     * @return True if the header is valid and the elements fit in the buffer.
+     */
+    bool parseHeader(const char* data, size_t length);
+
+    /**
+     * @brief Finds a member of the mapped .npz archive and parses it.
+     * @param member The name of the array, without the .npy suffix.
+     * @return True if the member was found and parsed.
+     */
+    bool openMember(const std::string& member);
+
+public:
+    /**
+     * @brief Opens a .npy file, or an array of a .npz archive.
+     * @param filename The path of the file.
+     * @param member The name of the array in a .npz archive, empty for a .npy file.
+     */
+    explicit NpyArray(const std::string& filename, const std::string& member = "");
+
+    NpyArray(const NpyArray&) = delete;
+    NpyArray& operator=(const NpyArray&) = delete;
+
+    /**
+     * @brief Checks whether the array was opened.
+     * @return True if the elements are available.
+     */
+    bool isOpen() const { return error.empty(); }
+
+    /**
+     * @brief Returns why the array could not be opened.
+     * @return The error message, empty if the array is open.
+     */
+    const std::string& getError() const { return error; }
+
+    /**
+     * @brief Returns the NumPy type kind of the elements.
+     * @return 'f' for floats, 'i' and 'u' for integers, 'b' for booleans, 'U' and 'S' for strings.
+     */
+    char getKind() const { return kind; }
+
+    /**
+     * @brief Returns the size of one element.
+     * @return The size in bytes.
+     */
+    size_t getItemSize() const { return itemSize; }
+
+    /**
+     * @brief Returns the dimensions of the array.
+     * @return The size of every dimension.
+     */
+    const std::vector<size_t>& getShape() const { return shape; }
+
+    /**
+     * @brief Checks whether the array is stored column by column.
+     * @return True for Fortran order, false for C order.
+     */
+    bool isFortranOrder() const { return fortranOrder; }
+
+    /**
+     * @brief Returns the number of elements.
+     * @return The product of the dimensions.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the first element, in place in the mapping when possible.
+     * @return Pointer to the raw elements, which may not be aligned.
+     */
+    const char* data() const { return elements; }
+
+    /**
+     * @brief Reads a numeric or boolean element as a double.
+     * @param row The row of the element.
+     * @param column The column of the element, 0 for one-dimensional arrays.
+     * @return The value of the element.
+     */
+    double valueAt(size_t row, size_t column = 0) const;
+
+    /**
+     * @brief Reads an element as text: strings as they are, numbers in decimal.
+     * @param index The index of the element in a one-dimensional array.
+     * @return The text of the element.
+     */
+    std::string textAt(size_t index) const;
+};
@@ -9,10 +9,21 @@ namespace RandomUtils {
      */
     void seedRandom(unsigned int seedValue);
 
+    /**
+     * Gives the calling thread its own random number generator.
+     * 
+     * Every function of this namespace called from the thread draws from it
+     * instead of the shared generator, so threads that run in parallel neither
+     * race on the shared state nor depend on each other's timing.
+     * 
+     * @param generator The generator of the thread, or nullptr to use the shared one again.
+     */
+    void setThreadGenerator(std::mt19937* generator);
+
     /**
      * Random generator getter.
      * 
-     * @return The random generator.
+     * @return The generator of the calling thread if it has one, the shared generator otherwise.
      */
     std::mt19937& getGenerator();
 
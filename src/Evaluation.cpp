@@ -1,13 +1,91 @@
 #include "Evaluation.hpp"
 #include "utils/MathUtils.hpp"
 #include <algorithm>
+#include <future>
 #include <limits>
 #include <omp.h>
-#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <Eigen/Dense>
 
-Evaluation::Evaluation(const DataSet& trainingData, float alpha, float reductionThreshold) : 
-                        nn(trainingData), alpha(alpha), reductionThreshold(reductionThreshold) {}
+namespace {
+    // Returns a dataset reading the rows of another one without copying them
+    DataSet sharedRows(const DataSet& dataset) {
+        return dataset.isView() ? dataset : DataSet::view(dataset, 0, dataset.size());
+    }
+
+    using RowMatrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using AlignedRows = std::vector<float, AlignedAllocator<float, DataSet::ROW_ALIGNMENT>>;
+
+    // Copies a range of rows of a dataset into search order.
+    void gatherRows(const DataSet& dataset, const OneNN::SearchData& layout, size_t first, size_t count, AlignedRows& out) {
+        out.resize(count * layout.stride);
+        for (size_t r = 0; r < count; ++r) {
+            layout.permute(dataset.row(first + r), out.data() + r * layout.stride);
+        }
+    }
+
+    // Writes the squared differences of rows i and j, one column per listed feature.
+    void writePairDifferences(const DataSet& dataset, size_t i, size_t j,
+                              const std::vector<uint32_t>& features, float* out) {
+        DataRow rowI = dataset.row(i);
+        DataRow rowJ = dataset.row(j);
+        for (size_t k = 0; k < features.size(); ++k) {
+            float diff = rowI[features[k]] - rowJ[features[k]];
+            out[k] = diff * diff;
+        }
+    }
+
+    // The threads granted to every evaluation run by the solution-level loop of evaluateBatch on this thread, 0 outside it.
+    thread_local size_t nestedEvaluationThreads = 0;
+
+    // The threads one evaluation may use: all of them at the top level, its share inside the solution-level
+    // loop of evaluateBatch, and one inside any other parallel region.
+    size_t evaluationThreads() {
+        if (!omp_in_parallel()) {
+            return static_cast<size_t>(omp_get_max_threads());
+        }
+        return std::max<size_t>(1, nestedEvaluationThreads);
+    }
+
+    // Keeps the nearest neighbor of a query, the lowest index winning ties.
+    inline void updateNearest(float dist, size_t candidate, float& nearestDistance, uint32_t& nearestIndex) {
+        if (dist < nearestDistance || (dist == nearestDistance && candidate < nearestIndex)) {
+            nearestDistance = dist;
+            nearestIndex = static_cast<uint32_t>(candidate);
+        }
+    }
+}
+
+Evaluation::Evaluation(const DataSet& trainingData, float alpha, float reductionThreshold, size_t fitnessCacheCapacity,
+                       size_t memoryBudget, bool deduplicate) : 
+                        nn(sharedRows(trainingData)), alpha(alpha), reductionThreshold(reductionThreshold),
+                        fitnessCache(fitnessCacheCapacity),
+                        memoryBudget(memoryBudget) {
+    // Copies of a row are only worth collapsing when the rows are dense, in memory, and some repeat
+    if (deduplicate && !trainingData.isSparse() && !isOutOfCore()) {
+        uniqueRows = DataLoader::deduplicate(trainingData);
+        deduplicated = uniqueRows.rows.size() < trainingData.size();
+        if (!deduplicated) {
+            uniqueRows = DataLoader::UniqueRows();
+        }
+    }
+
+    size_t n = leaveOneOutData().size();
+    previousNearest.reset(new std::atomic<uint32_t>[n]);
+    for (size_t i = 0; i < n; ++i) {
+        previousNearest[i].store(std::numeric_limits<uint32_t>::max(), std::memory_order_relaxed);
+    }
+}
+
+bool Evaluation::isOutOfCore() const {
+    const DataSet& trainingData = nn.getTrainingData();
+    return !trainingData.isSparse() && trainingData.size() * trainingData.getStride() * sizeof(float) > memoryBudget;
+}
+
+bool Evaluation::isTrainingData(const DataSet& dataset) const {
+    return dataset.sharesRowsWith(nn.getTrainingData());
+}
 
 std::vector<float> Evaluation::getFitnessRecords() const {
     return fitnessRecords;
@@ -19,50 +97,338 @@ void Evaluation::insertFitnessRecord(float fitness) {
 }
 
 Solution Evaluation::reduceSolution(const Solution& solution) {
-    Solution reducedSolution = solution;
-    for (size_t i = 0; i < reducedSolution.weights.size(); ++i) {
-        if (reducedSolution.weights[i] < reductionThreshold) {
-            reducedSolution.weights[i] = 0.0f;
-        }
+    return reduceWeights(solution.weights.data(), solution.size());
+}
+
+Solution Evaluation::reduceWeights(const float* weights, size_t numWeights) {
+    Solution reducedSolution(numWeights, Solution::Uninitialized{});
+    for (size_t i = 0; i < numWeights; ++i) {
+        reducedSolution.weights[i] = weights[i] < reductionThreshold ? 0.0f : weights[i];
     }
     return reducedSolution;
 }
 
-float Evaluation::leaveOneOutCrossValidation(const DataSet& dataset, const Solution& solution) {
-    std::atomic<size_t> correctPredictions{0};
-    Solution reducedSolution = reduceSolution(solution);
+size_t Evaluation::numSolutionGroups(size_t numThreads, size_t numSolutions, size_t numBlocks) const {
+    // By default, just enough groups that every thread of a group has a block of its own
+    size_t groups = solutionThreads > 0 ? solutionThreads : numThreads / std::clamp<size_t>(numBlocks, 1, numThreads);
+    return std::clamp<size_t>(groups, 1, std::max<size_t>(1, std::min(numThreads, numSolutions)));
+}
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < dataset.items.size(); ++i) {
-        std::string predictedLabel = nn.classifyExcludingIndex(dataset.items[i], i, reducedSolution);
-        if (predictedLabel == dataset.items[i].label) {
-            correctPredictions.fetch_add(1, std::memory_order_relaxed);
+size_t Evaluation::countCorrectCopies(size_t row, size_t nearestIndex, float nearestDistance) const {
+    const DataSet& data = leaveOneOutData();
+    bool sameClass = nearestIndex < data.size() && data.getClassId(nearestIndex) == data.getClassId(row);
+    if (!deduplicated || uniqueRows.counts[row] == 1) {
+        return sameClass;
+    }
+
+    // A copy is classified by the nearest distinct row only when that one ties at zero and comes before its earliest other copy
+    auto isCorrect = [&](size_t earliestOtherCopy) {
+        bool tiesEarlier = nearestIndex < data.size() && nearestDistance == 0.0f &&
+                           uniqueRows.firstOccurrences[nearestIndex] < earliestOtherCopy;
+        return !tiesEarlier || sameClass;
+    };
+    return (uniqueRows.counts[row] - 1) * isCorrect(uniqueRows.firstOccurrences[row]) +
+           isCorrect(uniqueRows.secondOccurrences[row]);
+}
+
+size_t Evaluation::countCorrectPredictions(const DataSet& dataset, const Solution& reducedSolution, bool leaveOneOut) {
+    const DataSet& trainingData = nn.getTrainingData();
+    std::vector<ClassId> classMap = dataset.mapClassIds(trainingData);
+    size_t numQueries = dataset.size();
+    size_t numTraining = trainingData.size();
+    size_t numThreads = evaluationThreads();
+
+    if (trainingData.isSparse()) {
+        return countCorrectSparse(dataset, reducedSolution, leaveOneOut);
+    }
+
+    // Training rows that do not fit in the budget even with only the active features are streamed in blocks
+    OneNN::SearchData layout = OneNN::layout(reducedSolution.weights, nn.getConstantFeatures());
+    if (numTraining * layout.stride * sizeof(float) > memoryBudget) {
+        return countCorrectBlocked(dataset, layout, leaveOneOut);
+    }
+
+    // Leave-one-out on the training data compares the training rows with each other
+    if (leaveOneOut && isTrainingData(dataset)) {
+        return countCorrectLeaveOneOut(OneNN::prepare(leaveOneOutData(), reducedSolution.weights, nn.getConstantFeatures()));
+    }
+
+    OneNN::SearchData search = nn.prepare(reducedSolution);
+
+    auto isCorrect = [&](size_t i, const OneNN::Neighbor& nearest) {
+        return nearest.index != OneNN::NO_INDEX &&
+               trainingData.getClassId(nearest.index) == classMap[dataset.getClassId(i)];
+    };
+
+    size_t correctPredictions = 0;
+
+    // Split the queries when there are enough of them or each scan is too short to split
+    bool splitQueries = numThreads == 1 || numQueries >= MIN_QUERIES_PER_THREAD * numThreads ||
+                        numTraining * dataset.getNumFeatures() < MIN_SPLIT_SCAN_WORK;
+
+    if (splitQueries) {
+        #pragma omp parallel num_threads(numThreads)
+        {
+            std::vector<float> buffer(search.stride);
+
+            #pragma omp for schedule(static) reduction(+:correctPredictions)
+            for (size_t i = 0; i < numQueries; ++i) {
+                search.permute(dataset.row(i), buffer.data());
+                OneNN::Neighbor nearest = nn.nearestNeighbor(search, buffer.data(), leaveOneOut ? i : OneNN::NO_INDEX,
+                                                             0, numTraining, OneNN::noNeighbor());
+                correctPredictions += isCorrect(i, nearest);
+            }
+        }
+    } else {
+        // Every thread scans a contiguous range of the training data; merging the
+        // ranges keeps the lowest index on ties
+        std::vector<OneNN::Neighbor> partial(numThreads);
+        std::vector<float> buffer(search.stride);
+
+        #pragma omp parallel num_threads(numThreads)
+        {
+            size_t thread = omp_get_thread_num();
+            size_t activeThreads = omp_get_num_threads();
+            size_t chunk = (numTraining + activeThreads - 1) / activeThreads;
+            size_t begin = std::min(thread * chunk, numTraining);
+            size_t end = std::min(begin + chunk, numTraining);
+
+            for (size_t i = 0; i < numQueries; ++i) {
+                #pragma omp single
+                search.permute(dataset.row(i), buffer.data());
+
+                partial[thread] = nn.nearestNeighbor(search, buffer.data(), leaveOneOut ? i : OneNN::NO_INDEX,
+                                                     begin, end, OneNN::noNeighbor());
+                #pragma omp barrier
+                #pragma omp single
+                {
+                    OneNN::Neighbor nearest = partial[0];
+                    for (size_t t = 1; t < activeThreads; ++t) {
+                        if (partial[t].distance < nearest.distance ||
+                            (partial[t].distance == nearest.distance && partial[t].index < nearest.index)) {
+                            nearest = partial[t];
+                        }
+                    }
+                    correctPredictions += isCorrect(i, nearest);
+                }
+            }
         }
     }
 
-    float classificationRate = static_cast<float>(correctPredictions.load(std::memory_order_relaxed)) / dataset.items.size() * 100.0f;
-    return classificationRate;
+    return correctPredictions;
 }
 
-float Evaluation::calculateClassificationRate(const DataSet& dataset, const Solution& solution) {
+size_t Evaluation::countCorrectSparse(const DataSet& dataset, const Solution& reducedSolution, bool leaveOneOut) {
+    const DataSet& trainingData = nn.getTrainingData();
+    std::vector<ClassId> classMap = dataset.mapClassIds(trainingData);
+    size_t numQueries = dataset.size();
+    size_t numTraining = trainingData.size();
+    size_t numThreads = evaluationThreads();
+    const float* weights = reducedSolution.weights.data();
+
+    std::vector<float> trainingNorms(numTraining);
+    #pragma omp parallel for num_threads(numThreads) schedule(static)
+    for (size_t j = 0; j < numTraining; ++j) {
+        trainingNorms[j] = MathUtils::weightedSquaredNorm(trainingData.sparseRow(j), weights);
+    }
+
     size_t correctPredictions = 0;
-    Solution reducedSolution = reduceSolution(solution);
-    
-    for (const auto& item : dataset.items) {        
-        std::string predictedLabel = nn.classify(item, reducedSolution);
-        if (predictedLabel == item.label) {
-            ++correctPredictions;
+    #pragma omp parallel for num_threads(numThreads) schedule(static) reduction(+:correctPredictions)
+    for (size_t i = 0; i < numQueries; ++i) {
+        SparseRow query = dataset.sparseRow(i);
+        float queryNorm = MathUtils::weightedSquaredNorm(query, weights);
+        float nearestDistance = std::numeric_limits<float>::max();
+        uint32_t nearestIndex = std::numeric_limits<uint32_t>::max();
+        for (size_t j = 0; j < numTraining; ++j) {
+            if (leaveOneOut && j == i) {
+                continue;
+            }
+            float dist = MathUtils::weightedSquaredEuclideanDistance(trainingData.sparseRow(j), query, weights,
+                                                                     trainingNorms[j], queryNorm);
+            updateNearest(dist, j, nearestDistance, nearestIndex);
+        }
+        correctPredictions += nearestIndex < numTraining &&
+                              trainingData.getClassId(nearestIndex) == classMap[dataset.getClassId(i)];
+    }
+
+    return correctPredictions;
+}
+
+size_t Evaluation::countCorrectBlocked(const DataSet& dataset, const OneNN::SearchData& layout, bool leaveOneOut) {
+    const DataSet& trainingData = nn.getTrainingData();
+    std::vector<ClassId> classMap = dataset.mapClassIds(trainingData);
+    size_t numQueries = dataset.size();
+    size_t numTraining = trainingData.size();
+    size_t numThreads = evaluationThreads();
+    size_t numFeatures = layout.order.size();
+    size_t stride = layout.stride;
+
+    // One query block and two training blocks, one scanned while the other is read
+    size_t blockRows = std::max<size_t>(1, memoryBudget / (3 * stride * sizeof(float)));
+    AlignedRows queries, current, next;
+    std::vector<OneNN::Neighbor> nearest;
+    size_t correctPredictions = 0;
+
+    for (size_t firstQuery = 0; firstQuery < numQueries; firstQuery += blockRows) {
+        size_t numBlockQueries = std::min(blockRows, numQueries - firstQuery);
+        gatherRows(dataset, layout, firstQuery, numBlockQueries, queries);
+        nearest.assign(numBlockQueries, OneNN::noNeighbor());
+
+        std::future<void> prefetch = std::async(std::launch::async, gatherRows, std::cref(trainingData), std::cref(layout),
+                                                0, std::min(blockRows, numTraining), std::ref(next));
+        for (size_t firstTraining = 0; firstTraining < numTraining; firstTraining += blockRows) {
+            prefetch.get();
+            std::swap(current, next);
+            size_t numBlockTraining = std::min(blockRows, numTraining - firstTraining);
+            size_t nextTraining = firstTraining + numBlockTraining;
+            if (nextTraining < numTraining) {
+                prefetch = std::async(std::launch::async, gatherRows, std::cref(trainingData), std::cref(layout),
+                                      nextTraining, std::min(blockRows, numTraining - nextTraining), std::ref(next));
+            }
+
+            #pragma omp parallel for num_threads(numThreads) schedule(static)
+            for (size_t q = 0; q < numBlockQueries; ++q) {
+                const float* query = queries.data() + q * stride;
+                size_t excludeIndex = leaveOneOut ? firstQuery + q : OneNN::NO_INDEX;
+                OneNN::Neighbor& best = nearest[q];
+                for (size_t r = 0; r < numBlockTraining; ++r) {
+                    size_t candidate = firstTraining + r;
+                    if (candidate == excludeIndex) {
+                        continue;
+                    }
+                    float dist = MathUtils::weightedSquaredEuclideanDistanceBounded(current.data() + r * stride, query,
+                                                                                    layout.weights.data(), numFeatures, best.distance);
+                    if (dist < best.distance || (dist == best.distance && candidate < best.index)) {
+                        best.distance = dist;
+                        best.index = candidate;
+                    }
+                }
+            }
+        }
+
+        for (size_t q = 0; q < numBlockQueries; ++q) {
+            correctPredictions += nearest[q].index != OneNN::NO_INDEX &&
+                                  trainingData.getClassId(nearest[q].index) == classMap[dataset.getClassId(firstQuery + q)];
+        }
+    }
+
+    return correctPredictions;
+}
+
+size_t Evaluation::countCorrectLeaveOneOut(const OneNN::SearchData& search) {
+    size_t n = leaveOneOutData().size();
+    size_t numFeatures = search.order.size();
+    size_t numThreads = evaluationThreads();
+    if (n < 2) {
+        return n == 1 ? countCorrectCopies(0, OneNN::NO_INDEX, std::numeric_limits<float>::max()) : 0;
+    }
+
+    // The previous nearest neighbors give every search a bound from the start
+    std::vector<OneNN::Neighbor> seeds(n);
+    #pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t previous = previousNearest[i].load(std::memory_order_relaxed);
+        seeds[i] = previous < n && previous != i ? nn.distanceTo(search, search.row(i), previous) : OneNN::noNeighbor();
+    }
+
+    size_t tileRows = std::max<size_t>(8, LOO_TILE_BYTES / (search.stride * sizeof(float)));
+    size_t numTiles = (n + tileRows - 1) / tileRows;
+    size_t numTilePairs = numTiles * (numTiles + 1) / 2;
+    std::vector<std::vector<OneNN::Neighbor>> partial(numThreads);
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+        std::vector<OneNN::Neighbor>& nearest = partial[omp_get_thread_num()];
+        nearest = seeds;
+
+        auto update = [&](OneNN::Neighbor& best, float dist, size_t candidate) {
+            if (dist < best.distance || (dist == best.distance && candidate < best.index)) {
+                best.distance = dist;
+                best.index = candidate;
+            }
+        };
+
+        #pragma omp for schedule(static, 1)
+        for (size_t tilePair = 0; tilePair < numTilePairs; ++tilePair) {
+            // Map the linear index to the tile pair (tileI, tileJ) with tileI <= tileJ
+            size_t tileI = 0, remaining = tilePair;
+            while (remaining >= numTiles - tileI) {
+                remaining -= numTiles - tileI;
+                ++tileI;
+            }
+            size_t tileJ = tileI + remaining;
+
+            size_t iEnd = std::min((tileI + 1) * tileRows, n);
+            size_t jEnd = std::min((tileJ + 1) * tileRows, n);
+            for (size_t i = tileI * tileRows; i < iEnd; ++i) {
+                const float* rowI = search.row(i);
+                size_t jBegin = tileI == tileJ ? i + 1 : tileJ * tileRows;
+                for (size_t j = jBegin; j < jEnd; ++j) {
+                    float bound = std::max(nearest[i].distance, nearest[j].distance);
+                    float dist = MathUtils::weightedSquaredEuclideanDistanceBounded(search.row(j), rowI, search.weights.data(), numFeatures, bound);
+                    if (dist <= bound) {
+                        update(nearest[i], dist, j);
+                        update(nearest[j], dist, i);
+                    }
+                }
+            }
+        }
+
+        // Merge the per-thread minima, each thread taking a static slice of the instances
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            OneNN::Neighbor best = partial[0][i];
+            for (size_t t = 1; t < partial.size(); ++t) {
+                if (!partial[t].empty()) {
+                    update(best, partial[t][i].distance, partial[t][i].index);
+                }
+            }
+            seeds[i] = best;
         }
     }
-    return static_cast<float>(correctPredictions) / dataset.items.size() * 100.0f;
+
+    size_t correctPredictions = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (seeds[i].index != OneNN::NO_INDEX) {
+            previousNearest[i].store(static_cast<uint32_t>(seeds[i].index), std::memory_order_relaxed);
+        }
+        correctPredictions += countCorrectCopies(i, seeds[i].index, seeds[i].distance);
+    }
+    return correctPredictions;
+}
+
+float Evaluation::leaveOneOutCrossValidation(const DataSet& dataset, const Solution& solution) {
+    Solution reducedSolution = reduceSolution(solution);
+    bool cacheable = fitnessCache.isEnabled() && isTrainingData(dataset);
+    float classificationRate;
+    if (cacheable && fitnessCache.find(reducedSolution.weights, classificationRate)) {
+        return classificationRate;
+    }
+
+    size_t correctPredictions = countCorrectPredictions(dataset, reducedSolution, true);
+    classificationRate = static_cast<float>(correctPredictions) / dataset.size() * 100.0f;
+    if (cacheable) {
+        fitnessCache.insert(reducedSolution.weights, classificationRate);
+    }
+    return classificationRate;
+}
+
+float Evaluation::calculateClassificationRate(const DataSet& dataset, const Solution& solution) {
+    Solution reducedSolution = reduceSolution(solution);
+    size_t correctPredictions = countCorrectPredictions(dataset, reducedSolution, false);
+    return static_cast<float>(correctPredictions) / dataset.size() * 100.0f;
 }
 
 float Evaluation::calculateReductionRate(const Solution& solution) {
+    return calculateReductionRate(solution.weights.data(), solution.size());
+}
+
+float Evaluation::calculateReductionRate(const float* weights, size_t numWeights) {
     size_t reducedFeatures = 0;
-    for (const auto& weight : solution.weights) {
-        if (weight < 0.1f) ++reducedFeatures;
+    for (size_t i = 0; i < numWeights; ++i) {
+        if (weights[i] < 0.1f) ++reducedFeatures;
     }
-    return static_cast<float>(reducedFeatures) / solution.weights.size() * 100.0f;
+    return static_cast<float>(reducedFeatures) / numWeights * 100.0f;
 }
 
 float Evaluation::calculateFitness(float classificationRate, float reductionRate) {
@@ -91,6 +457,274 @@ EvaluatedSolution Evaluation::evaluate(const Solution& solution, const DataSet&
     return {solution, fitness};
 }
 
+bool Evaluation::buildDifferenceTensor() {
+    if (differenceTensorBuilt.load(std::memory_order_acquire)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(differenceTensorMutex);
+    if (differenceTensorBuilt.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    const DataSet& data = leaveOneOutData();
+    const std::vector<bool>& constantFeatures = nn.getConstantFeatures();
+    size_t numFeatures = data.getNumFeatures();
+    std::vector<uint32_t> features;
+    for (size_t k = 0; k < numFeatures; ++k) {
+        if (!constantFeatures[k]) {
+            features.push_back(static_cast<uint32_t>(k));
+        }
+    }
+
+    size_t n = data.size();
+    size_t d = features.size();
+    size_t numPairs = n * (n - 1) / 2;
+    if (d == 0 || numPairs > BATCH_MEMORY_BUDGET / sizeof(float) / d) {
+        return false;
+    }
+
+    differenceTensor.resize(numPairs * d);
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < n; ++i) {
+        size_t firstPair = i * (2 * n - i - 1) / 2;
+        for (size_t j = i + 1; j < n; ++j) {
+            writePairDifferences(data, i, j, features, differenceTensor.data() + (firstPair + j - i - 1) * d);
+        }
+    }
+
+    tensorFeatures = std::move(features);
+
+    differenceTensorBuilt.store(true, std::memory_order_release);
+    return true;
+}
+
+std::vector<EvaluationResult> Evaluation::evaluateBatch(const std::vector<Solution>& solutions) {
+    std::vector<EvaluationResult> results(solutions.size());
+    std::vector<Solution> reducedSolutions;
+    reducedSolutions.reserve(solutions.size());
+    for (size_t p = 0; p < solutions.size(); ++p) {
+        reducedSolutions.push_back(reduceSolution(solutions[p]));
+        results[p].reductionRate = calculateReductionRate(solutions[p]);
+    }
+    classifyBatch(reducedSolutions, results);
+    return results;
+}
+
+std::vector<EvaluationResult> Evaluation::evaluateBatch(const PopulationMatrix& population) {
+    std::vector<EvaluationResult> results(population.size());
+    std::vector<Solution> reducedSolutions;
+    reducedSolutions.reserve(population.size());
+    for (size_t p = 0; p < population.size(); ++p) {
+        reducedSolutions.push_back(reduceWeights(population.row(p), population.getNumWeights()));
+        results[p].reductionRate = calculateReductionRate(population.row(p), population.getNumWeights());
+    }
+    classifyBatch(reducedSolutions, results);
+    return results;
+}
+
+void Evaluation::classifyBatch(std::vector<Solution>& candidates, std::vector<EvaluationResult>& results) {
+    const DataSet& data = leaveOneOutData();
+    size_t n = data.size();
+    size_t numInstances = nn.getTrainingData().size();
+    size_t numSolutions = candidates.size();
+    if (numSolutions == 0) {
+        return;
+    }
+
+    // Only the solutions missing from the fitness cache go through the product
+    std::vector<Solution> reducedSolutions;
+    std::vector<size_t> pending;
+    for (size_t p = 0; p < numSolutions; ++p) {
+        if (fitnessCache.find(candidates[p].weights, results[p].classificationRate)) {
+            continue;
+        }
+        pending.push_back(p);
+        reducedSolutions.push_back(std::move(candidates[p]));
+    }
+
+    // Sparse rows have no dense differences to multiply, and rows out of memory cannot be
+    // read pair by pair, so both are scanned one solution at a time
+    size_t numThreads = evaluationThreads();
+    if (data.isSparse() || isOutOfCore()) {
+        // Groups of threads take whole solutions, except out of core, where one scan already fills the memory budget
+        size_t numGroups = isOutOfCore() ? 1 : numSolutionGroups(numThreads, pending.size(), 1);
+        size_t instanceThreads = std::max<size_t>(1, numThreads / numGroups);
+        // Nesting is a process-wide setting, so it is raised only for this section and restored after it
+        int previousLevels = omp_get_max_active_levels();
+        bool nested = numGroups > 1 && instanceThreads > 1 && previousLevels < 2;
+        if (nested) {
+            omp_set_max_active_levels(2);
+        }
+
+        std::vector<float> classificationRates(pending.size());
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(numGroups)
+        for (size_t p = 0; p < pending.size(); ++p) {
+            nestedEvaluationThreads = instanceThreads;
+            classificationRates[p] = static_cast<float>(countCorrectPredictions(nn.getTrainingData(), reducedSolutions[p], true)) /
+                                     numInstances * 100.0f;
+            nestedEvaluationThreads = 0;
+        }
+        if (nested) {
+            omp_set_max_active_levels(previousLevels);
+        }
+
+        for (size_t p = 0; p < pending.size(); ++p) {
+            results[pending[p]].classificationRate = classificationRates[p];
+            fitnessCache.insert(reducedSolutions[p].weights, classificationRates[p]);
+        }
+        pending.clear();
+        reducedSolutions.clear();
+    }
+
+    // Features that are constant or weighted zero by every pending solution add nothing to the product
+    size_t numPending = pending.size();
+    const std::vector<bool>& constantFeatures = nn.getConstantFeatures();
+    size_t numFeatures = data.getNumFeatures();
+    std::vector<uint32_t> activeFeatures;
+    for (size_t k = 0; k < numFeatures; ++k) {
+        bool weighted = false;
+        for (size_t p = 0; p < numPending && !weighted; ++p) {
+            weighted = reducedSolutions[p].weights[k] != 0.0f;
+        }
+        if (weighted && !constantFeatures[k]) {
+            activeFeatures.push_back(static_cast<uint32_t>(k));
+        }
+    }
+
+    // The cached tensor holds every non-constant feature, so it only pays off while most of them are active
+    size_t numPairs = n > 1 && numPending > 0 ? n * (n - 1) / 2 : 0;
+    bool cached = numPairs > 0 && !activeFeatures.empty() && buildDifferenceTensor() &&
+                  2 * activeFeatures.size() > tensorFeatures.size();
+    const std::vector<uint32_t>& features = cached ? tensorFeatures : activeFeatures;
+    size_t d = features.size();
+
+    Eigen::MatrixXf weightMatrix(d, numPending);
+    for (size_t p = 0; p < numPending; ++p) {
+        for (size_t k = 0; k < d; ++k) {
+            weightMatrix(k, p) = reducedSolutions[p].weights[features[k]];
+        }
+    }
+
+    size_t pairsPerBlock = std::clamp<size_t>(BATCH_BLOCK_BYTES / (sizeof(float) * std::max<size_t>(d, 1)), 64, 65536);
+    size_t numBlocks = (numPairs + pairsPerBlock - 1) / pairsPerBlock;
+
+    // The threads are split into groups that each take a contiguous share of the solutions, and the
+    // threads of a group split its blocks of pairs. Every worker keeps the nearest neighbors of its
+    // solutions over its own blocks, so nothing is shared until the merge
+    size_t numGroups = numSolutionGroups(numThreads, numPending, numBlocks);
+    size_t lanes = std::clamp<size_t>(numThreads / numGroups, 1, std::max<size_t>(numBlocks, 1));
+    size_t numWorkers = numBlocks > 0 ? numGroups * lanes : 0;
+    auto firstSolution = [&](size_t group) { return group * numPending / numGroups; };
+    std::vector<std::vector<float>> partialDistance(numWorkers);
+    std::vector<std::vector<uint32_t>> partialIndex(numWorkers);
+
+    #pragma omp parallel num_threads(std::max<size_t>(numWorkers, 1)) if (numWorkers > 1)
+    {
+        RowMatrix block;
+        Eigen::MatrixXf blockDistances;
+        std::vector<uint32_t> pairI(pairsPerBlock), pairJ(pairsPerBlock);
+
+        // A thread takes more than one worker when the team is smaller than asked for
+        for (size_t worker = omp_get_thread_num(); worker < numWorkers; worker += omp_get_num_threads()) {
+            size_t group = worker / lanes;
+            size_t lane = worker % lanes;
+            size_t first = firstSolution(group);
+            size_t groupSize = firstSolution(group + 1) - first;
+            size_t firstBlock = lane * numBlocks / lanes;
+            size_t lastBlock = (lane + 1) * numBlocks / lanes;
+            std::vector<float>& bestDistances = partialDistance[worker];
+            std::vector<uint32_t>& bestIndices = partialIndex[worker];
+            bestDistances.assign(groupSize * n, std::numeric_limits<float>::max());
+            bestIndices.assign(groupSize * n, std::numeric_limits<uint32_t>::max());
+            if (firstBlock == lastBlock) {
+                continue;
+            }
+
+            // Find the pair (i, j) the first block starts at
+            size_t i = 0;
+            size_t offset = firstBlock * pairsPerBlock;
+            while (offset >= n - 1 - i) {
+                offset -= n - 1 - i;
+                ++i;
+            }
+            size_t j = i + 1 + offset;
+
+            for (size_t blockIndex = firstBlock; blockIndex < lastBlock; ++blockIndex) {
+                size_t firstPair = blockIndex * pairsPerBlock;
+                size_t count = std::min(pairsPerBlock, numPairs - firstPair);
+                if (!cached) {
+                    block.resize(count, d);
+                }
+                for (size_t q = 0; q < count; ++q) {
+                    pairI[q] = static_cast<uint32_t>(i);
+                    pairJ[q] = static_cast<uint32_t>(j);
+                    if (!cached) {
+                        writePairDifferences(data, i, j, features, block.row(q).data());
+                    }
+                    if (++j == n) {
+                        ++i;
+                        j = i + 1;
+                    }
+                }
+
+                if (cached) {
+                    Eigen::Map<const RowMatrix> cachedBlock(differenceTensor.data() + firstPair * d, count, d);
+                    blockDistances.noalias() = cachedBlock * weightMatrix.middleCols(first, groupSize);
+                } else {
+                    blockDistances.noalias() = block * weightMatrix.middleCols(first, groupSize);
+                }
+
+                for (size_t p = 0; p < groupSize; ++p) {
+                    const float* dist = blockDistances.col(p).data();
+                    float* bestDistance = bestDistances.data() + p * n;
+                    uint32_t* bestIndex = bestIndices.data() + p * n;
+                    for (size_t q = 0; q < count; ++q) {
+                        updateNearest(dist[q], pairJ[q], bestDistance[pairI[q]], bestIndex[pairI[q]]);
+                        updateNearest(dist[q], pairI[q], bestDistance[pairJ[q]], bestIndex[pairJ[q]]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Nearest neighbor of every instance for every solution, stored solution by solution; the
+    // lanes of a group are merged with the same tie rule, so the split never changes the result
+    std::vector<float> nearestDistance(numPending * n, std::numeric_limits<float>::max());
+    std::vector<uint32_t> nearestIndex(numPending * n, std::numeric_limits<uint32_t>::max());
+    #pragma omp parallel for schedule(static) num_threads(numThreads)
+    for (size_t p = 0; p < numPending; ++p) {
+        for (size_t worker = 0; worker < numWorkers; ++worker) {
+            size_t first = firstSolution(worker / lanes);
+            if (p < first || p >= firstSolution(worker / lanes + 1)) {
+                continue;
+            }
+            const float* dist = partialDistance[worker].data() + (p - first) * n;
+            const uint32_t* index = partialIndex[worker].data() + (p - first) * n;
+            for (size_t q = 0; q < n; ++q) {
+                updateNearest(dist[q], index[q], nearestDistance[p * n + q], nearestIndex[p * n + q]);
+            }
+        }
+    }
+
+    for (size_t p = 0; p < numPending; ++p) {
+        const float* bestDistance = nearestDistance.data() + p * n;
+        const uint32_t* bestIndex = nearestIndex.data() + p * n;
+        size_t correctPredictions = 0;
+        for (size_t q = 0; q < n; ++q) {
+            correctPredictions += countCorrectCopies(q, bestIndex[q], bestDistance[q]);
+        }
+
+        float classificationRate = static_cast<float>(correctPredictions) / numInstances * 100.0f;
+        results[pending[p]].classificationRate = classificationRate;
+        fitnessCache.insert(reducedSolutions[p].weights, classificationRate);
+    }
+
+    for (size_t p = 0; p < numSolutions; ++p) {
+        EvaluationResult& result = results[p];
+        result.fitness = calculateFitness(result.classificationRate, result.reductionRate);
+    }
+}
+
 void Evaluation::clearFitnessRecords() {
     fitnessRecords.clear();
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "FitnessCache.hpp"
+#include <cstring>
+
+FitnessCache::FitnessCache(size_t capacity)
+    : capacity(capacity), shardCapacity(capacity / NUM_SHARDS) {}
+
+uint64_t FitnessCache::hashWeights(const std::vector<float>& weights) {
+    // FNV-1a over the indices and bit patterns of the non-zero weights
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i] != 0.0f) {
+            uint32_t bits;
+            std::memcpy(&bits, &weights[i], sizeof(bits));
+            hash = (hash ^ i) * 1099511628211ull;
+            hash = (hash ^ bits) * 1099511628211ull;
+        }
+    }
+    return (hash ^ weights.size()) * 1099511628211ull;
+}
+
+bool FitnessCache::matches(const Entry& entry, const std::vector<float>& weights) {
+    if (entry.numWeights != weights.size()) {
+        return false;
+    }
+    size_t next = 0;
+    for (size_t k = 0; k < entry.indices.size(); ++k) {
+        // Every weight skipped between two stored ones must be zero
+        for (; next < entry.indices[k]; ++next) {
+            if (weights[next] != 0.0f) {
+                return false;
+            }
+        }
+        if (weights[next] != entry.values[k]) {
+            return false;
+        }
+        ++next;
+    }
+    for (; next < weights.size(); ++next) {
+        if (weights[next] != 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t FitnessCache::entryBytes(size_t numNonZero) {
+    // The entry and its weights, plus the links of its list node and its hash map node
+    constexpr size_t nodeOverhead = 2 * sizeof(void*) + sizeof(std::pair<uint64_t, std::list<Entry>::iterator>) + 2 * sizeof(void*);
+    return sizeof(Entry) + nodeOverhead + numNonZero * (sizeof(uint32_t) + sizeof(float));
+}
+
+bool FitnessCache::find(const std::vector<float>& reducedWeights, float& classificationRate) {
+    if (capacity == 0) {
+        return false;
+    }
+
+    uint64_t hash = hashWeights(reducedWeights);
+    Shard& shard = shards[hash % NUM_SHARDS];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(hash);
+        if (it != shard.index.end() && matches(*it->second, reducedWeights)) {
+            shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+            classificationRate = it->second->classificationRate;
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void FitnessCache::insert(const std::vector<float>& reducedWeights, float classificationRate) {
+    if (capacity == 0) {
+        return;
+    }
+
+    Entry entry{hashWeights(reducedWeights), reducedWeights.size(), {}, {}, classificationRate};
+    for (size_t i = 0; i < reducedWeights.size(); ++i) {
+        if (reducedWeights[i] != 0.0f) {
+            entry.indices.push_back(static_cast<uint32_t>(i));
+            entry.values.push_back(reducedWeights[i]);
+        }
+    }
+    size_t bytes = entryBytes(entry.indices.size());
+    if (bytes > shardCapacity) {
+        return;
+    }
+
+    Shard& shard = shards[entry.hash % NUM_SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(entry.hash);
+    if (it != shard.index.end()) {
+        // Same hash: refresh the entry, replacing the weights on a collision
+        shard.bytes -= entryBytes(it->second->indices.size());
+        shard.entries.erase(it->second);
+        shard.index.erase(it);
+    }
+
+    while (!shard.entries.empty() && shard.bytes + bytes > shardCapacity) {
+        shard.bytes -= entryBytes(shard.entries.back().indices.size());
+        shard.index.erase(shard.entries.back().hash);
+        shard.entries.pop_back();
+    }
+    uint64_t hash = entry.hash;
+    shard.entries.push_front(std::move(entry));
+    shard.index.emplace(hash, shard.entries.begin());
+    shard.bytes += bytes;
+}
+
+void FitnessCache::clear() {
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+    }
+    hits.store(0, std::memory_order_relaxed);
+    misses.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,174 @@
+#include "IncrementalEvaluator.hpp"
+#include "algorithms/1NN.hpp"
+#include "data/DataLoader.hpp"
+#include "utils/MathUtils.hpp"
+#include <limits>
+#include <omp.h>
+
+IncrementalEvaluator::IncrementalEvaluator(std::shared_ptr<Evaluation> eval, const DataSet& dataset,
+    size_t memoryBudget, size_t resyncInterval) : eval(eval), dataset(dataset),
+    resyncInterval(resyncInterval), columnIndex(dataset.getNumFeatures()), classificationRate(0.0f),
+    commitsSinceResync(0), pendingIndex(0), pendingWeight(0.0f), pendingRate(0.0f), hasPending(false) {
+    size_t n = dataset.size();
+    enabled = !dataset.isSparse() && !eval->isOutOfCore() && n > 1 && n <= memoryBudget / sizeof(float) / n;
+    cacheable = enabled && eval->getFitnessCache().isEnabled() && eval->isTrainingData(dataset);
+    if (enabled) {
+        distances.resize(n * n);
+        column.resize(n);
+        constantFeatures = DataLoader::findConstantFeatures(dataset);
+    }
+}
+
+float IncrementalEvaluator::fitnessOf(const Solution& solution, float rate) const {
+    float redRate = eval->calculateReductionRate(solution);
+    return eval->calculateFitness(rate, redRate);
+}
+
+void IncrementalEvaluator::loadColumn(size_t index) {
+    if (columnIndex == index) {
+        return;
+    }
+    for (size_t j = 0; j < dataset.size(); ++j) {
+        column[j] = dataset.row(j)[index];
+    }
+    columnIndex = index;
+}
+
+void IncrementalEvaluator::resync() {
+    size_t n = dataset.size();
+    OneNN::SearchData search = OneNN::prepare(dataset, weights, constantFeatures);
+    size_t numActive = search.order.size();
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < n; ++i) {
+        const float* rowI = search.row(i);
+        distances[i * n + i] = 0.0f;
+        for (size_t j = i + 1; j < n; ++j) {
+            float dist = MathUtils::weightedSquaredEuclideanDistance(rowI, search.row(j), search.weights.data(), numActive);
+            distances[i * n + j] = dist;
+            distances[j * n + i] = dist;
+        }
+    }
+
+    size_t correct = 0;
+    #pragma omp parallel for reduction(+:correct)
+    for (size_t i = 0; i < n; ++i) {
+        const float* row = distances.data() + i * n;
+        float minDistance = std::numeric_limits<float>::max();
+        size_t nearest = i;
+        for (size_t j = 0; j < n; ++j) {
+            if (j != i && row[j] < minDistance) {
+                minDistance = row[j];
+                nearest = j;
+            }
+        }
+        if (nearest != i && dataset.getClassId(nearest) == dataset.getClassId(i)) {
+            ++correct;
+        }
+    }
+
+    classificationRate = static_cast<float>(correct) / n * 100.0f;
+    commitsSinceResync = 0;
+}
+
+float IncrementalEvaluator::reset(const Solution& solution) {
+    hasPending = false;
+    if (!enabled) {
+        return eval->calculateFitnessLeaveOneOut(dataset, solution);
+    }
+
+    weights = eval->reduceSolution(solution).weights;
+    resync();
+    return fitnessOf(solution, classificationRate);
+}
+
+float IncrementalEvaluator::propose(const Solution& neighbor, size_t index) {
+    if (!enabled) {
+        return eval->calculateFitnessLeaveOneOut(dataset, neighbor);
+    }
+
+    float newWeight = neighbor.weights[index] < eval->getReductionThreshold() ? 0.0f : neighbor.weights[index];
+    float delta = newWeight - weights[index];
+    float rate = classificationRate;
+
+    // A constant feature differs by zero between every pair, so its weight moves no distance
+    if (delta != 0.0f && !constantFeatures[index]) {
+        std::vector<float> reducedWeights;
+        bool cached = false;
+        if (cacheable) {
+            reducedWeights = weights;
+            reducedWeights[index] = newWeight;
+            cached = eval->getFitnessCache().find(reducedWeights, rate);
+        }
+
+        if (!cached) {
+            size_t n = dataset.size();
+            loadColumn(index);
+
+            size_t correct = 0;
+            #pragma omp parallel for reduction(+:correct)
+            for (size_t i = 0; i < n; ++i) {
+                const float* row = distances.data() + i * n;
+                float xi = column[i];
+                float minDistance = std::numeric_limits<float>::max();
+                size_t nearest = i;
+                for (size_t j = 0; j < n; ++j) {
+                    float diff = xi - column[j];
+                    float dist = row[j] + delta * diff * diff;
+                    if (j != i && dist < minDistance) {
+                        minDistance = dist;
+                        nearest = j;
+                    }
+                }
+                if (nearest != i && dataset.getClassId(nearest) == dataset.getClassId(i)) {
+                    ++correct;
+                }
+            }
+
+            rate = static_cast<float>(correct) / n * 100.0f;
+        }
+    }
+
+    pendingIndex = index;
+    pendingWeight = newWeight;
+    pendingRate = rate;
+    hasPending = true;
+    return fitnessOf(neighbor, rate);
+}
+
+void IncrementalEvaluator::commit() {
+    if (!enabled || !hasPending) {
+        return;
+    }
+    hasPending = false;
+
+    float delta = pendingWeight - weights[pendingIndex];
+    if (delta == 0.0f || constantFeatures[pendingIndex]) {
+        weights[pendingIndex] = pendingWeight;
+        classificationRate = pendingRate;
+        return;
+    }
+
+    size_t n = dataset.size();
+    loadColumn(pendingIndex);
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < n; ++i) {
+        float* row = distances.data() + i * n;
+        float xi = column[i];
+        for (size_t j = 0; j < n; ++j) {
+            float diff = xi - column[j];
+            row[j] += delta * diff * diff;
+        }
+    }
+
+    weights[pendingIndex] = pendingWeight;
+    classificationRate = pendingRate;
+    if (++commitsSinceResync >= resyncInterval) {
+        resync();
+    }
+}
+
+void IncrementalEvaluator::rollback() {
+    hasPending = false;
+}
@@ -0,0 +1,89 @@
+#include "PopulationMatrix.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Rounds the number of weights up to a whole number of aligned blocks
+    size_t strideFor(size_t numWeights) {
+        constexpr size_t floatsPerBlock = PopulationMatrix::ROW_ALIGNMENT / sizeof(float);
+        return (numWeights + floatsPerBlock - 1) / floatsPerBlock * floatsPerBlock;
+    }
+}
+
+PopulationMatrix::PopulationMatrix(size_t numRows, size_t numWeights)
+    : weights(numRows * strideFor(numWeights)), fitness(numRows), numRows(numRows), numWeights(numWeights),
+      stride(strideFor(numWeights)) {}
+
+PopulationMatrix PopulationMatrix::fromSolutions(const std::vector<Solution>& solutions) {
+    PopulationMatrix population(solutions.size(), solutions.empty() ? 0 : solutions[0].size());
+    for (size_t i = 0; i < solutions.size(); ++i) {
+        population.setSolution(i, solutions[i]);
+    }
+    return population;
+}
+
+void PopulationMatrix::resize(size_t numRows, size_t numWeights) {
+    this->numRows = numRows;
+    this->numWeights = numWeights;
+    stride = strideFor(numWeights);
+    weights.resize(numRows * stride);
+    fitness.resize(numRows);
+}
+
+size_t PopulationMatrix::bestIndex() const {
+    return std::distance(fitness.begin(), std::max_element(fitness.begin(), fitness.end()));
+}
+
+Solution PopulationMatrix::getSolution(size_t index) const {
+    Solution solution(numWeights, Solution::Uninitialized{});
+    std::copy(row(index), row(index) + numWeights, solution.weights.begin());
+    return solution;
+}
+
+void PopulationMatrix::setSolution(size_t index, const Solution& solution) {
+    std::copy(solution.weights.begin(), solution.weights.end(), row(index));
+}
+
+void PopulationMatrix::copyRow(size_t index, const PopulationMatrix& source, size_t sourceIndex) {
+    std::copy(source.row(sourceIndex), source.row(sourceIndex) + numWeights, row(index));
+    fitness[index] = source.fitness[sourceIndex];
+}
+
+std::vector<float> PopulationMatrix::weightVariances() const {
+    std::vector<float> means(numWeights, 0.0f);
+    std::vector<float> variances(numWeights, 0.0f);
+    if (numRows == 0) {
+        return variances;
+    }
+    float* meanData = means.data();
+    float* varianceData = variances.data();
+
+    for (size_t i = 0; i < numRows; ++i) {
+        const float* weight = row(i);
+        for (size_t j = 0; j < numWeights; ++j) {
+            meanData[j] += weight[j];
+        }
+    }
+    for (size_t j = 0; j < numWeights; ++j) {
+        meanData[j] /= numRows;
+    }
+    for (size_t i = 0; i < numRows; ++i) {
+        const float* weight = row(i);
+        for (size_t j = 0; j < numWeights; ++j) {
+            float deviation = weight[j] - meanData[j];
+            varianceData[j] += deviation * deviation;
+        }
+    }
+    for (size_t j = 0; j < numWeights; ++j) {
+        varianceData[j] /= numRows;
+    }
+    return variances;
+}
+
+void PopulationMatrix::swap(PopulationMatrix& other) {
+    weights.swap(other.weights);
+    fitness.swap(other.fitness);
+    std::swap(numRows, other.numRows);
+    std::swap(numWeights, other.numWeights);
+    std::swap(stride, other.stride);
+}
@@ -6,6 +6,7 @@ Solution::Solution(size_t numberOfFeatures) : weights(numberOfFeatures) {
     initializeRandomly();
 }
 Solution::Solution(size_t numberOfFeatures, float value) : weights(numberOfFeatures, value) {}
+Solution::Solution(size_t numberOfFeatures, Uninitialized) : weights(numberOfFeatures) {}
 
 void Solution::initializeRandomly() {
     for (auto& weight : weights) {
@@ -25,13 +26,6 @@ size_t Solution::size() const {
     return weights.size();
 }
 
-Solution& Solution::operator=(const Solution& other) {
-    if (this != &other) {
-        weights = other.weights;
-    }
-    return *this;
-}
-
 Solution Solution::operator+(const Solution& other) const {
     Solution result(weights.size());
     for (size_t i = 0; i < weights.size(); ++i) {
@@ -1,67 +1,120 @@
 #include "algorithms/1NN.hpp"
+#include "data/DataLoader.hpp"
 #include "utils/MathUtils.hpp"
+#include <algorithm>
 #include <limits>
-#include <omp.h>
-
-OneNN::OneNN(const DataSet& trainingData) : KNNClassifier(trainingData, 1) {}
-
-std::string OneNN::classify(const DataItem& item, const Solution& solution) const {
-    float globalMinDistance = std::numeric_limits<float>::max();
-    std::string nearestLabel;
-
-    #pragma omp parallel
-    {
-        float localMinDistance = std::numeric_limits<float>::max();
-        std::string localNearestLabel;
-
-        #pragma omp for nowait
-        for (size_t i = 0; i < trainingData.size(); ++i) {
-            float dist = MathUtils::weightedEuclideanDistance(trainingData[i].features, item.features, solution.weights);
-            if (dist < localMinDistance) {
-                localMinDistance = dist;
-                localNearestLabel = trainingData[i].label;
-            }
-        }
 
-        #pragma omp critical
-        {
-            if (localMinDistance < globalMinDistance) {
-                globalMinDistance = localMinDistance;
-                nearestLabel = localNearestLabel;
-            }
+OneNN::OneNN(const DataSet& trainingData) : KNNClassifier(trainingData, 1),
+    constantFeatures(DataLoader::findConstantFeatures(trainingData)) {}
+
+OneNN::Neighbor OneNN::noNeighbor() {
+    return Neighbor{std::numeric_limits<float>::max(), NO_INDEX};
+}
+
+void OneNN::SearchData::permute(const DataRow& testRow, float* out) const {
+    for (size_t k = 0; k < order.size(); ++k) {
+        out[k] = testRow[order[k]];
+    }
+}
+
+OneNN::SearchData OneNN::prepare(const Solution& solution) const {
+    return prepare(trainingData, solution.weights, constantFeatures);
+}
+
+OneNN::SearchData OneNN::layout(const std::vector<float>& weights, const std::vector<bool>& constantFeatures) {
+    SearchData search;
+    size_t numFeatures = constantFeatures.size();
+
+    for (size_t k = 0; k < numFeatures; ++k) {
+        if (weights[k] != 0.0f && !constantFeatures[k]) {
+            search.order.push_back(static_cast<uint32_t>(k));
         }
     }
+    std::stable_sort(search.order.begin(), search.order.end(), [&](uint32_t a, uint32_t b) {
+        return weights[a] > weights[b];
+    });
+
+    size_t numActive = search.order.size();
+    search.weights.resize(numActive);
+    for (size_t k = 0; k < numActive; ++k) {
+        search.weights[k] = weights[search.order[k]];
+    }
 
-    return nearestLabel;
+    // Rows stay aligned, padded like the rows of a dataset but never empty
+    search.stride = DataSet::strideFor(std::max<size_t>(numActive, 1));
+    return search;
 }
 
-std::string OneNN::classifyExcludingIndex(const DataItem& item, size_t excludeIndex, const Solution& solution) {
-    float minDistance = std::numeric_limits<float>::max();
-    std::string nearestLabel;
-
-    #pragma omp parallel
-    {
-        float localMinDistance = std::numeric_limits<float>::max();
-        std::string localNearestLabel;
-        #pragma omp for nowait
-        for (size_t i = 0; i < trainingData.size(); ++i) {
-            if (i == excludeIndex) {
-                continue;
-            }
-            float dist = MathUtils::weightedEuclideanDistance(trainingData[i].features, item.features, solution.weights);
-            if (dist < localMinDistance) {
-                localMinDistance = dist;
-                localNearestLabel = trainingData[i].label;
-            }
+OneNN::SearchData OneNN::prepare(const DataSet& data, const std::vector<float>& weights,
+                                 const std::vector<bool>& constantFeatures) {
+    SearchData search = layout(weights, constantFeatures);
+    search.rows.assign(data.size() * search.stride, 0.0f);
+    for (size_t i = 0; i < data.size(); ++i) {
+        search.permute(data.row(i), search.rows.data() + i * search.stride);
+    }
+    return search;
+}
+
+OneNN::Neighbor OneNN::distanceTo(const SearchData& search, const float* query, size_t index) const {
+    float dist = MathUtils::weightedSquaredEuclideanDistanceBounded(search.row(index), query, search.weights.data(),
+                                                                    search.order.size(), std::numeric_limits<float>::max());
+    return Neighbor{dist, index};
+}
+
+OneNN::Neighbor OneNN::nearestNeighbor(const SearchData& search, const float* query, size_t excludeIndex,
+                                       size_t begin, size_t end, Neighbor seed) const {
+    Neighbor nearest = seed;
+    for (size_t i = begin; i < end; ++i) {
+        if (i == excludeIndex || i == seed.index) {
+            continue;
+        }
+        float dist = MathUtils::weightedSquaredEuclideanDistanceBounded(search.row(i), query, search.weights.data(),
+                                                                        search.order.size(), nearest.distance);
+        if (dist < nearest.distance || (dist == nearest.distance && i < nearest.index)) {
+            nearest.distance = dist;
+            nearest.index = i;
         }
-        #pragma omp critical
-        {
-            if (localMinDistance < minDistance) {
-                minDistance = localMinDistance;
-                nearestLabel = localNearestLabel;
-            }
+    }
+    return nearest;
+}
+
+OneNN::Neighbor OneNN::nearestNeighbor(const DataRow& row, size_t excludeIndex, const Solution& solution) const {
+    // Constant features add the same amount to every distance, so they are weighted zero as in a prepared search
+    std::vector<float> weights(solution.weights.begin(), solution.weights.end());
+    for (size_t k = 0; k < weights.size(); ++k) {
+        if (constantFeatures[k]) {
+            weights[k] = 0.0f;
         }
     }
 
-    return nearestLabel;
-}
\ No newline at end of file
+    Neighbor nearest = noNeighbor();
+    for (size_t i = 0; i < trainingData.size(); ++i) {
+        if (i == excludeIndex) {
+            continue;
+        }
+        float dist = MathUtils::weightedSquaredEuclideanDistanceBounded(trainingData.row(i).features, row.features,
+                                                                        weights.data(), weights.size(), nearest.distance);
+        if (dist < nearest.distance) {
+            nearest.distance = dist;
+            nearest.index = i;
+        }
+    }
+    return nearest;
+}
+
+ClassId OneNN::classify(const SearchData& search, const DataRow& row, size_t excludeIndex) const {
+    std::vector<float> query(search.stride);
+    search.permute(row, query.data());
+    Neighbor nearest = nearestNeighbor(search, query.data(), excludeIndex, 0, trainingData.size(), noNeighbor());
+    return nearest.index == NO_INDEX ? DataSet::NO_CLASS : trainingData.getClassId(nearest.index);
+}
+
+ClassId OneNN::classify(const DataRow& row, const Solution& solution) const {
+    Neighbor nearest = nearestNeighbor(row, NO_INDEX, solution);
+    return nearest.index == NO_INDEX ? DataSet::NO_CLASS : trainingData.getClassId(nearest.index);
+}
+
+ClassId OneNN::classifyExcludingIndex(const DataRow& row, size_t excludeIndex, const Solution& solution) {
+    Neighbor nearest = nearestNeighbor(row, excludeIndex, solution);
+    return nearest.index == NO_INDEX ? DataSet::NO_CLASS : trainingData.getClassId(nearest.index);
+}
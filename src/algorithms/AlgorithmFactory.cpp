@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 #include <map>
 #include <string>
@@ -18,6 +19,8 @@
 #include "algorithms/ILS.hpp"
 #include "algorithms/ILS_SA.hpp"
 #include "algorithms/CMAES.hpp"
+#include "algorithms/IslandGA.hpp"
+#include "algorithms/AsyncSGA.hpp"
 
 std::unique_ptr<Algorithm> AlgorithmFactory::createAlgorithm(
     const std::string& name, 
@@ -69,6 +72,43 @@ std::unique_ptr<Algorithm> AlgorithmFactory::createAlgorithm(
     } else if (name == "agg-ca") {
         initializeParameters(maxEvaluations, populationSize, crossoverRate, mutationRate);
         return std::make_unique<GGAAC>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate);
+    } else if (name == "island-age-blx" || name == "island-age-ca" || name == "island-agg-blx" || name == "island-agg-ca") {
+        size_t defaultIslands = 4;
+
+        initializeParameters(maxEvaluations, populationSize, crossoverRate, mutationRate);
+        size_t numIslands = parameters.find("islands") != parameters.end() ? static_cast<size_t>(parameters.at("islands")) : defaultIslands;
+        size_t migrationInterval = parameters.find("migrationInterval") != parameters.end() ? static_cast<size_t>(parameters.at("migrationInterval")) : IslandGA::DEFAULT_MIGRATION_INTERVAL;
+        size_t numMigrants = parameters.find("migrants") != parameters.end() ? static_cast<size_t>(parameters.at("migrants")) : IslandGA::DEFAULT_MIGRANTS;
+        bool randomTopology = parameters.find("randomTopology") != parameters.end() && parameters.at("randomTopology") != 0.0f;
+
+        std::vector<std::shared_ptr<GeneticAlgorithm>> islands;
+        for (size_t island = 0; island < std::max<size_t>(1, numIslands); ++island) {
+            if (name == "island-age-blx") {
+                islands.push_back(std::make_shared<SGABLX>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate));
+            } else if (name == "island-age-ca") {
+                islands.push_back(std::make_shared<SGAAC>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate));
+            } else if (name == "island-agg-blx") {
+                islands.push_back(std::make_shared<GGABLX>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate));
+            } else {
+                islands.push_back(std::make_shared<GGAAC>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate));
+            }
+        }
+
+        return std::make_unique<IslandGA>(eval, islands, maxEvaluations, migrationInterval, numMigrants,
+                                          randomTopology ? IslandGA::Topology::Random : IslandGA::Topology::Ring);
+    } else if (name == "async-age-blx" || name == "async-age-ca") {
+        initializeParameters(maxEvaluations, populationSize, crossoverRate, mutationRate);
+        size_t numWorkers = parameters.find("workers") != parameters.end() ? static_cast<size_t>(parameters.at("workers")) : 0;
+        size_t queueCapacity = parameters.find("queueCapacity") != parameters.end() ? static_cast<size_t>(parameters.at("queueCapacity")) : 0;
+
+        std::shared_ptr<GeneticAlgorithm> ga;
+        if (name == "async-age-blx") {
+            ga = std::make_shared<SGABLX>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate);
+        } else {
+            ga = std::make_shared<SGAAC>(eval, populationSize, maxEvaluations, mutationRate, crossoverRate);
+        }
+
+        return std::make_unique<AsyncSGA>(eval, ga, maxEvaluations, numWorkers, queueCapacity);
     } else if (name == "memetic") {
         size_t defaultMaxEvaluations = 15000;
         size_t defaultOptimizationFrequency = 10;
@@ -0,0 +1,103 @@
+#include "algorithms/AsyncSGA.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <omp.h>
+#include <thread>
+
+namespace {
+    // The children waiting for an evaluation and the evaluated ones waiting to be inserted
+    struct EvaluationQueue {
+        std::deque<Solution> pending;
+        std::deque<EvaluatedSolution> evaluated;
+        std::mutex mutex;
+        std::condition_variable changed; // Signals a child queued or evaluated, or the end of the run
+        bool stopping = false;
+    };
+}
+
+AsyncSGA::AsyncSGA(std::shared_ptr<Evaluation> eval, std::shared_ptr<GeneticAlgorithm> ga, size_t maxEvaluations,
+                   size_t numWorkers, size_t queueCapacity)
+    : eval(eval), ga(ga), maxEvaluations(maxEvaluations), numWorkers(numWorkers), queueCapacity(queueCapacity) {}
+
+EvaluatedSolution AsyncSGA::run(const DataSet& dataset) {
+    size_t numThreads = static_cast<size_t>(omp_get_max_threads());
+    size_t workers = numWorkers > 0 ? numWorkers : numThreads;
+    size_t capacity = queueCapacity > 0 ? queueCapacity : CHILDREN_PER_WORKER * workers;
+    size_t threadsPerWorker = std::max<size_t>(1, numThreads / workers);
+
+    ga->clearEvaluations();
+    PopulationMatrix population = ga->startRun(dataset);
+    std::vector<float>& populationFitness = population.getFitness();
+    evaluations = ga->getEvaluations();
+    ga->clearEvaluations();
+
+    EvaluationQueue queue;
+    auto evaluate = [&]() {
+        omp_set_num_threads(static_cast<int>(threadsPerWorker));
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        while (true) {
+            queue.changed.wait(lock, [&] { return queue.stopping || !queue.pending.empty(); });
+            if (queue.pending.empty()) {
+                return;
+            }
+            std::vector<Solution> child{std::move(queue.pending.front())};
+            queue.pending.pop_front();
+            lock.unlock();
+            float fitness = eval->evaluateBatch(child)[0].fitness;
+            lock.lock();
+            queue.evaluated.push_back(EvaluatedSolution{std::move(child[0]), fitness});
+            queue.changed.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t worker = 0; worker < workers; ++worker) {
+        threads.emplace_back(evaluate);
+    }
+
+    PopulationMatrix children;
+    size_t inFlight = 0;
+    while (evaluations < maxEvaluations || inFlight > 0) {
+        // Breed generations until the queue is full or the budget is handed out
+        while (evaluations < maxEvaluations && inFlight < capacity) {
+            eval->insertFitnessRecord(populationFitness[population.bestIndex()]);
+            ga->recombine_population(population, ga->select_for_reproduction(population), children);
+            ga->mutate_population(children);
+            {
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                for (size_t k = 0; k < children.size(); ++k) {
+                    queue.pending.push_back(children.getSolution(k));
+                }
+            }
+            queue.changed.notify_all();
+            inFlight += children.size();
+            evaluations += children.size();
+        }
+
+        // Insert the next evaluated child in place of the worst individual if it is better
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        queue.changed.wait(lock, [&] { return !queue.evaluated.empty(); });
+        EvaluatedSolution child = std::move(queue.evaluated.front());
+        queue.evaluated.pop_front();
+        lock.unlock();
+        --inFlight;
+        size_t worst = std::distance(populationFitness.begin(), std::min_element(populationFitness.begin(), populationFitness.end()));
+        if (child.fitness > populationFitness[worst]) {
+            population.setSolution(worst, child.solution);
+            populationFitness[worst] = child.fitness;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.stopping = true;
+    }
+    queue.changed.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t bestIndex = population.bestIndex();
+    return EvaluatedSolution{population.getSolution(bestIndex), populationFitness[bestIndex]};
+}
@@ -40,27 +40,29 @@ void CMAES::initializeParameters(size_t dimension) {
     chiN = std::sqrt(dimension) * (1 - 1/(4*dimension) + 1/(21*dimension*dimension));
 }
 
-std::vector<Solution> CMAES::generatePopulation(const Eigen::VectorXf& mean,
-                                              float sigma,
-                                              const Eigen::MatrixXf& C,
-                                              size_t dimension) {
+PopulationMatrix CMAES::generatePopulation(const Eigen::VectorXf& mean,
+                                           float sigma,
+                                           const Eigen::MatrixXf& C,
+                                           size_t dimension) {
     Eigen::LLT<Eigen::MatrixXf> cholDecomp(C);
     Eigen::MatrixXf L = cholDecomp.matrixL();
     
-    std::vector<Solution> population(lambda, Solution(dimension));
-    
+    // One standard normal sample per row, drawn in the order of the individuals
+    RowMajorMatrix Z(lambda, dimension);
     for (size_t i = 0; i < lambda; i++) {
-        Eigen::VectorXf z(dimension);
-        for (size_t j = 0; j < dimension; j++) {
-            z(j) = RandomUtils::getRandomNormal(0.0f, 1.0f);
-        }
-        
-        Eigen::VectorXf x = mean + sigma * (L * z);
         for (size_t j = 0; j < dimension; j++) {
-            population[i].weights[j] = std::clamp(x(j), 0.0f, 1.0f);
+            Z(i, j) = RandomUtils::getRandomNormal(0.0f, 1.0f);
         }
     }
     
+    // The whole population is sampled with one matrix product, written into the rows of the matrix
+    PopulationMatrix population(lambda, dimension);
+    Eigen::Map<RowMajorMatrix, Eigen::Unaligned, Eigen::OuterStride<>> X(population.row(0), lambda, dimension,
+                                                                         Eigen::OuterStride<>(population.getStride()));
+    X.noalias() = sigma * Z * L.transpose();
+    X.rowwise() += mean.transpose();
+    X = X.cwiseMax(0.0f).cwiseMin(1.0f);
+    
     return population;
 }
 
@@ -83,21 +85,32 @@ EvaluatedSolution CMAES::run(const DataSet& dataset) {
     Eigen::VectorXf ps = Eigen::VectorXf::Zero(dimension);
     float sigma = 0.3;
     
-    Solution bestSolution(dimension);
+    Solution bestSolution(dimension, 0.0f);
+    bool trainingData = eval->isTrainingData(dataset);
     float bestFitness = std::numeric_limits<float>::lowest();
     
     while (evaluations < maxEvaluations) {
         // Generate and evaluate population
         auto population = generatePopulation(mean, sigma, C, dimension);
         std::vector<float> fitness(lambda);
+        if (trainingData) {
+            std::vector<EvaluationResult> results = eval->evaluateBatch(population);
+            for (size_t i = 0; i < lambda; i++) {
+                fitness[i] = results[i].fitness;
+            }
+        } else {
+            // The batch only scores the training data, so any other dataset is evaluated one solution at a time
+            for (size_t i = 0; i < lambda; i++) {
+                fitness[i] = eval->calculateFitnessLeaveOneOut(dataset, population.getSolution(i));
+            }
+        }
         
         for (size_t i = 0; i < lambda; i++) {
-            fitness[i] = eval->calculateFitnessLeaveOneOut(dataset, population[i]);
             evaluations++;
             
             if (fitness[i] > bestFitness) {
                 bestFitness = fitness[i];
-                bestSolution = population[i];
+                bestSolution = population.getSolution(i);
             }
         }
         
@@ -110,7 +123,7 @@ EvaluatedSolution CMAES::run(const DataSet& dataset) {
         
         for (size_t i = 0; i < mu; i++) {
             for (size_t j = 0; j < dimension; j++) {
-                mean(j) += weights[i] * population[indices[i]].weights[j];
+                mean(j) += weights[i] * population.row(indices[i])[j];
             }
         }
         
@@ -129,7 +142,7 @@ EvaluatedSolution CMAES::run(const DataSet& dataset) {
         for (size_t i = 0; i < mu; i++) {
             Eigen::VectorXf dv(dimension);
             for (size_t j = 0; j < dimension; j++) {
-                dv(j) = (population[indices[i]].weights[j] - oldMean(j)) / sigma;
+                dv(j) = (population.row(indices[i])[j] - oldMean(j)) / sigma;
             }
             C += cmu * weights[i] * dv * dv.transpose();
         }
@@ -2,6 +2,8 @@
 #include "Evaluation.hpp"
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <numeric>
 #include "utils/RandomUtils.hpp"
 
 GeneticAlgorithm::~GeneticAlgorithm() {}
@@ -16,22 +18,21 @@ GeneticAlgorithm::GeneticAlgorithm(std::shared_ptr<Evaluation> eval,
     : eval(eval), populationSize(populationSize), maxEvaluations(maxEvaluations),
       mutationRate(mutationRate), crossoverRate(crossoverRate), mean(mean), std(std) {}
 
-std::vector<float> GeneticAlgorithm::getPopulationFitness() const {
-    return populationFitness;
-}
-
-std::vector<float> GeneticAlgorithm::setPopulationFitness(std::vector<float> fitness) {
-    populationFitness = fitness;
-    return populationFitness;
-}
-
-std::vector<Solution> GeneticAlgorithm::initialize_population(size_t numberOfWeights) {
-    std::vector<Solution> population(populationSize, Solution(numberOfWeights));
+PopulationMatrix GeneticAlgorithm::initialize_population(size_t numberOfWeights) {
+    PopulationMatrix population(populationSize, numberOfWeights);
+    for (size_t i = 0; i < populationSize; ++i) {
+        float* weights = population.row(i);
+        for (size_t j = 0; j < numberOfWeights; ++j) {
+            weights[j] = RandomUtils::getRandomFloat(0.0f, 1.0f);
+        }
+    }
     return population;
 }
 
-std::vector<Solution> GeneticAlgorithm::tournament_selection(const std::vector<Solution>& population, size_t newPopulationSize, size_t tournamentSize) {
-    std::vector<Solution> selected;
+std::vector<size_t> GeneticAlgorithm::tournament_selection(const PopulationMatrix& population, size_t newPopulationSize, size_t tournamentSize) {
+    const std::vector<float>& populationFitness = population.getFitness();
+    std::vector<size_t> selected;
+    selected.reserve(newPopulationSize);
 
     for (size_t i = 0; i < newPopulationSize; ++i) {
         size_t bestIdx = RandomUtils::getRandomInt(0, population.size() - 1);
@@ -41,77 +42,97 @@ std::vector<Solution> GeneticAlgorithm::tournament_selection(const std::vector<S
                 bestIdx = idx;
             }
         }
-        selected.push_back(population[bestIdx]);
+        selected.push_back(bestIdx);
     }
 
     return selected;
 }
 
-std::vector<float> GeneticAlgorithm::evaluatePopulation(const std::vector<Solution>& population, const DataSet& dataset) {
-    std::vector<float> fitness(population.size());
-    for (size_t i = 0; i < population.size(); ++i) {
-        fitness[i] = eval->calculateFitnessLeaveOneOut(dataset, population[i]);
-        ++evaluations;
+void GeneticAlgorithm::evaluatePopulation(PopulationMatrix& population, const DataSet& dataset) {
+    std::vector<float>& fitness = population.getFitness();
+    if (eval->isTrainingData(dataset)) {
+        std::vector<EvaluationResult> results = eval->evaluateBatch(population);
+        for (size_t i = 0; i < population.size(); ++i) {
+            fitness[i] = results[i].fitness;
+        }
+    } else {
+        // The batch only scores the training data, so any other dataset is evaluated one solution at a time
+        for (size_t i = 0; i < population.size(); ++i) {
+            fitness[i] = eval->calculateFitnessLeaveOneOut(dataset, population.getSolution(i));
+        }
     }
-    return fitness;
+    evaluations += population.size();
+}
+
+PopulationMatrix GeneticAlgorithm::startRun(const DataSet& dataset) {
+    PopulationMatrix population = initialize_population(dataset.getNumFeatures());
+    evaluatePopulation(population, dataset);
+    return population;
+}
+
+void GeneticAlgorithm::runGeneration(PopulationMatrix& population, const DataSet& dataset) {
+    std::vector<size_t> parents = select_for_reproduction(population);
+    recombine_population(population, parents, offspring);
+    mutate_population(offspring);
+    replace_population(population, offspring, dataset);
 }
 
 EvaluatedSolution GeneticAlgorithm::run(const DataSet& dataset) {
-    auto population = initialize_population(dataset.getNumFeatures());
-    populationFitness = evaluatePopulation(population, dataset);
-
-    while (evaluations < maxEvaluations) {
-        float bestFitness = *std::max_element(populationFitness.begin(), populationFitness.end());
-        eval->insertFitnessRecord(bestFitness);
-        auto selected = select_for_reproduction(population);
-        auto recombined = recombine_population(selected);
-        auto mutated = mutate_population(recombined);
-        replace_population(population, mutated, dataset);
+    PopulationMatrix population = startRun(dataset);
+
+    while (hasEvaluationsLeft()) {
+        eval->insertFitnessRecord(population.getFitness()[population.bestIndex()]);
+        runGeneration(population, dataset);
     }
 
-    size_t bestIndex = std::distance(populationFitness.begin(), std::max_element(populationFitness.begin(), populationFitness.end()));
+    size_t bestIndex = population.bestIndex();
 
-    return EvaluatedSolution{population[bestIndex], populationFitness[bestIndex]};
+    return EvaluatedSolution{population.getSolution(bestIndex), population.getFitness()[bestIndex]};
 }
 
-std::vector<Solution> GeneticAlgorithm::blend_crossover(const Solution& parent1, const Solution& parent2, float alpha) {
-    Solution child1(parent1.size()), child2(parent2.size());
+void GeneticAlgorithm::blend_crossover(const float* parent1, const float* parent2, float* child1, float* child2, size_t numWeights, float alpha) {
+    // The two draws of every gene, in the order the per-gene operator made them
+    randomNumbers.resize(2 * numWeights);
+    float* draws1 = randomNumbers.data();
+    float* draws2 = draws1 + numWeights;
+    for (size_t j = 0; j < numWeights; ++j) {
+        draws1[j] = RandomUtils::getRandomFloat(0.0f, 1.0f);
+        draws2[j] = RandomUtils::getRandomFloat(0.0f, 1.0f);
+    }
 
-    // BLX-alpha crossover
-    for (size_t j = 0; j < parent1.size(); ++j) {
-        float Cmax = std::max(parent1.weights[j], parent2.weights[j]);
-        float Cmin = std::min(parent1.weights[j], parent2.weights[j]);
+    // BLX-alpha crossover, scaling every draw to its interval as a uniform distribution does
+    for (size_t j = 0; j < numWeights; ++j) {
+        float Cmax = std::max(parent1[j], parent2[j]);
+        float Cmin = std::min(parent1[j], parent2[j]);
         float I = (Cmax - Cmin > std::numeric_limits<float>::epsilon()) ? (Cmax - Cmin) : 0.0f;
 
         float lowerBound = Cmin - alpha * I;
         float upperBound = Cmax + alpha * I;
 
-        child1.weights[j] = std::clamp(RandomUtils::getRandomFloat(lowerBound, upperBound), 0.0f, 1.0f);
-        child2.weights[j] = std::clamp(RandomUtils::getRandomFloat(lowerBound, upperBound), 0.0f, 1.0f);
+        child1[j] = std::min(std::max(draws1[j] * (upperBound - lowerBound) + lowerBound, 0.0f), 1.0f);
+        child2[j] = std::min(std::max(draws2[j] * (upperBound - lowerBound) + lowerBound, 0.0f), 1.0f);
     }
-
-    return {child1, child2};
 }
 
-std::vector<Solution> GeneticAlgorithm::arithmetic_crossover(const Solution& parent1, const Solution& parent2) {
-    Solution child1(parent1.size()), child2(parent2.size());
+void GeneticAlgorithm::arithmetic_crossover(const float* parent1, const float* parent2, float* child1, float* child2, size_t numWeights) {
+    randomNumbers.resize(numWeights);
+    float* alphas = randomNumbers.data();
+    for (size_t j = 0; j < numWeights; ++j) {
+        alphas[j] = RandomUtils::getRandomFloat(0.0, 1.0);
+    }
 
     // Arithmetic crossover
-    for (size_t j = 0; j < parent1.size(); ++j) {
-        float alpha = RandomUtils::getRandomFloat(0.0, 1.0);
-        child1.weights[j] = alpha * parent1.weights[j] + (1 - alpha) * parent2.weights[j];
-        child2.weights[j] = (1 - alpha) * parent1.weights[j] + alpha * parent2.weights[j];
+    for (size_t j = 0; j < numWeights; ++j) {
+        float alpha = alphas[j];
+        child1[j] = alpha * parent1[j] + (1 - alpha) * parent2[j];
+        child2[j] = (1 - alpha) * parent1[j] + alpha * parent2[j];
     }
-
-    return {child1, child2};
 }
 
-void GeneticAlgorithm::competitive_replacement(std::vector<Solution>& population, std::vector<Solution>& newPopulation, const DataSet& dataset) {
-    std::vector<float> newPopulationFitness(newPopulation.size());
-    for (size_t i = 0; i < newPopulation.size(); ++i) {
-        newPopulationFitness[i] = eval->calculateFitnessLeaveOneOut(dataset, newPopulation[i]);
-        ++evaluations;
-    }
+void GeneticAlgorithm::competitive_replacement(PopulationMatrix& population, PopulationMatrix& newPopulation, const DataSet& dataset) {
+    evaluatePopulation(newPopulation, dataset);
+    const std::vector<float>& newPopulationFitness = newPopulation.getFitness();
+    const std::vector<float>& populationFitness = population.getFitness();
 
     // Sort new population indices by descending fitness (best first)
     std::vector<size_t> sortedNewIdx(newPopulation.size());
@@ -133,20 +154,17 @@ void GeneticAlgorithm::competitive_replacement(std::vector<Solution>& population
         for (size_t oldIdx = 0; oldIdx < newPopulation.size() && !replaced; ++oldIdx) {
             if (newPopulationFitness[sortedNewIdx[newIdx]] > populationFitness[sortedOldIdx[oldIdx]]) {
                 // Replace the old individual with the new one
-                population[sortedOldIdx[oldIdx]] = newPopulation[sortedNewIdx[newIdx]];
-                populationFitness[sortedOldIdx[oldIdx]] = newPopulationFitness[sortedNewIdx[newIdx]];
+                population.copyRow(sortedOldIdx[oldIdx], newPopulation, sortedNewIdx[newIdx]);
                 replaced = true;
             }
         }
     }
 }
 
-void GeneticAlgorithm::elitist_replacement(std::vector<Solution>& population, std::vector<Solution>& newPopulation, const DataSet& dataset) {
-    std::vector<float> newPopulationFitness(newPopulation.size());
-    for (size_t i = 0; i < newPopulation.size(); ++i) {
-        newPopulationFitness[i] = eval->calculateFitnessLeaveOneOut(dataset, newPopulation[i]);
-        ++evaluations;
-    }
+void GeneticAlgorithm::elitist_replacement(PopulationMatrix& population, PopulationMatrix& newPopulation, const DataSet& dataset) {
+    evaluatePopulation(newPopulation, dataset);
+    const std::vector<float>& populationFitness = population.getFitness();
+    const std::vector<float>& newPopulationFitness = newPopulation.getFitness();
 
     // Identify the best fitness in the old population
     float bestOldFitness = *std::max_element(populationFitness.begin(), populationFitness.end());
@@ -157,10 +175,8 @@ void GeneticAlgorithm::elitist_replacement(std::vector<Solution>& population, st
     float bestNewFitness = *std::max_element(newPopulationFitness.begin(), newPopulationFitness.end());
 
     if (bestOldFitness > bestNewFitness) {
-        newPopulation[worstNewIndex] = population[bestOldIndex];
-        newPopulationFitness[worstNewIndex] = bestOldFitness;
+        newPopulation.copyRow(worstNewIndex, population, bestOldIndex);
     }
 
-    population = std::move(newPopulation);
-    populationFitness = std::move(newPopulationFitness);
+    population.swap(newPopulation);
 }
@@ -2,49 +2,47 @@
 #include "utils/RandomUtils.hpp"
 #include <algorithm>
 
-std::vector<Solution> GGABLX::select_for_reproduction(const std::vector<Solution>& population) {
+std::vector<size_t> GGABLX::select_for_reproduction(const PopulationMatrix& population) {
     return tournament_selection(population, population.size(), 3);
 }
 
-std::vector<Solution> GGABLX::mutate_population(const std::vector<Solution>& population) {
+void GGABLX::mutate_population(PopulationMatrix& population) {
     size_t populationSize = population.size();
-    size_t numWeights = population[0].weights.size();
+    size_t numWeights = population.getNumWeights();
     size_t expectedMutations = static_cast<size_t>(populationSize * numWeights * mutationRate);
 
-    std::vector<Solution> mutated = population;
-
     for (size_t i = 0; i < expectedMutations; ++i) {
         size_t chromoIndex = RandomUtils::getRandomInt(0, populationSize - 1);
         size_t geneIndex = RandomUtils::getRandomInt(0, numWeights - 1);
-        mutated[chromoIndex].weights[geneIndex] += RandomUtils::getRandomNormal(mean, std);
-        mutated[chromoIndex].weights[geneIndex] = std::clamp(mutated[chromoIndex].weights[geneIndex], 0.0f, 1.0f);
+        float* weights = population.row(chromoIndex);
+        weights[geneIndex] += RandomUtils::getRandomNormal(mean, std);
+        weights[geneIndex] = std::clamp(weights[geneIndex], 0.0f, 1.0f);
     }
-
-    return mutated;
 }
 
-std::vector<Solution> GGABLX::recombine_population(const std::vector<Solution>& population) {
-    size_t populationSize = population.size();
-    std::vector<Solution> offspring;
+void GGABLX::recombine_population(const PopulationMatrix& population, const std::vector<size_t>& parents, PopulationMatrix& offspring) {
+    size_t numWeights = population.getNumWeights();
+    offspring.resize(parents.size(), numWeights);
 
-    for (size_t i = 0; i < populationSize; i += 2) {
-        const auto& parent1 = population[i];
-        const auto& parent2 = population[i + 1];
-        std::vector<Solution> children(2, Solution(parent1.size()));
+    for (size_t i = 0; i + 1 < parents.size(); i += 2) {
+        const float* parent1 = population.row(parents[i]);
+        const float* parent2 = population.row(parents[i + 1]);
 
         if (RandomUtils::getRandomFloat(0.0, 1.0) < crossoverRate) {
-            children = blend_crossover(parent1, parent2, 0.3);
+            blend_crossover(parent1, parent2, offspring.row(i), offspring.row(i + 1), numWeights, 0.3f);
         } else {
-            children[0] = parent1;
-            children[1] = parent2;
+            std::copy(parent1, parent1 + numWeights, offspring.row(i));
+            std::copy(parent2, parent2 + numWeights, offspring.row(i + 1));
         }
-
-        offspring.insert(offspring.end(), children.begin(), children.end());
     }
 
-    return offspring;
+    // Handle odd number of parents
+    if (parents.size() % 2 != 0) {
+        const float* last = population.row(parents.back());
+        std::copy(last, last + numWeights, offspring.row(parents.size() - 1));
+    }
 }
 
-void GGABLX::replace_population(std::vector<Solution>& population, std::vector<Solution>& newPopulation, const DataSet& dataset) {
+void GGABLX::replace_population(PopulationMatrix& population, PopulationMatrix& newPopulation, const DataSet& dataset) {
     elitist_replacement(population, newPopulation, dataset);
 }
@@ -0,0 +1,162 @@
+#include "algorithms/IslandGA.hpp"
+#include "utils/RandomUtils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <omp.h>
+#include <random>
+#include <thread>
+
+namespace {
+    // The migrants one island leaves for another, in one of two slots chosen by
+    // the parity of the migration number, so a sender may run one migration ahead
+    struct Mailbox {
+        struct Slot {
+            std::atomic<size_t> epoch{0}; // The migration whose migrants the slot holds, 0 if none
+            PopulationMatrix migrants; // The migrants with their fitness
+        };
+
+        Slot slots[2];
+        std::atomic<size_t> consumed{0}; // The last migration the owner took its migrants from
+        std::atomic<bool> finished{false}; // Whether the owner has spent its budget
+    };
+
+    // Returns the offset from an island to the island it sends to in the next migration
+    size_t nextOffset(IslandGA::Topology topology, std::mt19937& generator, size_t numIslands) {
+        if (topology == IslandGA::Topology::Ring || numIslands < 3) {
+            return 1;
+        }
+        return 1 + std::uniform_int_distribution<size_t>(0, numIslands - 2)(generator);
+    }
+
+    // Returns the indices of the fitness values from best to worst, ties by index
+    std::vector<size_t> rankByFitness(const std::vector<float>& fitness) {
+        std::vector<size_t> order(fitness.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fitness[a] > fitness[b]; });
+        return order;
+    }
+}
+
+IslandGA::IslandGA(std::shared_ptr<Evaluation> eval, std::vector<std::shared_ptr<GeneticAlgorithm>> islands,
+                   size_t maxEvaluations, size_t migrationInterval, size_t numMigrants, Topology topology)
+    : eval(eval), islands(islands), maxEvaluations(maxEvaluations), migrationInterval(std::max<size_t>(1, migrationInterval)),
+      numMigrants(numMigrants), topology(topology) {}
+
+EvaluatedSolution IslandGA::run(const DataSet& dataset) {
+    size_t numIslands = islands.size();
+    size_t threadsPerIsland = std::max<size_t>(1, omp_get_max_threads() / std::max<size_t>(1, numIslands));
+
+    // Every seed comes from the shared generator before any thread starts
+    std::vector<unsigned int> seeds(numIslands);
+    for (auto& seed : seeds) {
+        seed = static_cast<unsigned int>(RandomUtils::getRandomInt(0, std::numeric_limits<int>::max()));
+    }
+    unsigned int topologySeed = static_cast<unsigned int>(RandomUtils::getRandomInt(0, std::numeric_limits<int>::max()));
+
+    std::vector<Mailbox> mailboxes(numIslands);
+    std::vector<PopulationMatrix> populations(numIslands);
+    std::vector<std::vector<float>> bestFitness(numIslands);
+
+    auto runIsland = [&](size_t island) {
+        GeneticAlgorithm& ga = *islands[island];
+        std::mt19937 generator(seeds[island]);
+        std::mt19937 topologyGenerator(topologySeed);
+        RandomUtils::setThreadGenerator(&generator);
+        omp_set_num_threads(static_cast<int>(threadsPerIsland));
+
+        ga.clearEvaluations();
+        ga.setMaxEvaluations(maxEvaluations / numIslands + (island < maxEvaluations % numIslands ? 1 : 0));
+        PopulationMatrix& population = populations[island];
+        population = ga.startRun(dataset);
+
+        for (size_t generation = 1; ga.hasEvaluationsLeft(); ++generation) {
+            bestFitness[island].push_back(population.getFitness()[population.bestIndex()]);
+            ga.runGeneration(population, dataset);
+
+            if (numIslands < 2 || numMigrants == 0 || generation % migrationInterval != 0) {
+                continue;
+            }
+            size_t epoch = generation / migrationInterval;
+            size_t offset = nextOffset(topology, topologyGenerator, numIslands);
+
+            // Send copies of the best individuals once the destination took the migrants of two migrations ago
+            std::vector<size_t> ranking = rankByFitness(population.getFitness());
+            size_t count = std::min(numMigrants, population.size());
+            Mailbox& outbox = mailboxes[(island + offset) % numIslands];
+            while (outbox.consumed.load(std::memory_order_acquire) + 2 < epoch && !outbox.finished.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            Mailbox::Slot& sent = outbox.slots[epoch % 2];
+            sent.migrants.resize(count, population.getNumWeights());
+            for (size_t m = 0; m < count; ++m) {
+                sent.migrants.copyRow(m, population, ranking[m]);
+            }
+            sent.epoch.store(epoch, std::memory_order_release);
+
+            // Wait for the migrants of the source, unless it spent its budget before this migration
+            Mailbox& inbox = mailboxes[island];
+            Mailbox& source = mailboxes[(island + numIslands - offset) % numIslands];
+            Mailbox::Slot& received = inbox.slots[epoch % 2];
+            bool arrived = false;
+            while (!(arrived = received.epoch.load(std::memory_order_acquire) == epoch)) {
+                if (source.finished.load(std::memory_order_acquire)) {
+                    arrived = received.epoch.load(std::memory_order_acquire) == epoch;
+                    break;
+                }
+                std::this_thread::yield();
+            }
+
+            // The migrants take the place of the worst individuals they beat
+            if (arrived) {
+                for (size_t m = 0; m < received.migrants.size(); ++m) {
+                    size_t worst = ranking[population.size() - 1 - m];
+                    if (received.migrants.getFitness()[m] > population.getFitness()[worst]) {
+                        population.copyRow(worst, received.migrants, m);
+                    }
+                }
+            }
+            inbox.consumed.store(epoch, std::memory_order_release);
+        }
+
+        mailboxes[island].finished.store(true, std::memory_order_release);
+        RandomUtils::setThreadGenerator(nullptr);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t island = 0; island < numIslands; ++island) {
+        threads.emplace_back(runIsland, island);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Fitness records and the result are merged in island order
+    size_t numGenerations = 0;
+    evaluations = 0;
+    for (size_t island = 0; island < numIslands; ++island) {
+        numGenerations = std::max(numGenerations, bestFitness[island].size());
+        evaluations += islands[island]->getEvaluations();
+    }
+    for (size_t generation = 0; generation < numGenerations; ++generation) {
+        float best = -std::numeric_limits<float>::infinity();
+        for (size_t island = 0; island < numIslands; ++island) {
+            if (generation < bestFitness[island].size()) {
+                best = std::max(best, bestFitness[island][generation]);
+            }
+        }
+        eval->insertFitnessRecord(best);
+    }
+
+    EvaluatedSolution best{Solution(dataset.getNumFeatures(), 0.0f), -std::numeric_limits<float>::infinity()};
+    for (size_t island = 0; island < numIslands; ++island) {
+        const std::vector<float>& fitness = populations[island].getFitness();
+        for (size_t i = 0; i < fitness.size(); ++i) {
+            if (fitness[i] > best.fitness) {
+                best = EvaluatedSolution{populations[island].getSolution(i), fitness[i]};
+            }
+        }
+    }
+    return best;
+}
@@ -3,11 +3,29 @@
 #include <vector>
 #include <cmath>
 #include <algorithm>
-#include <unordered_map>
 #include <limits>
 #include <functional>
 #include <iostream>
-#include <omp.h>
+
+namespace {
+    // Majority vote among the first k neighbours; ties go to the lowest ClassId.
+    ClassId majorityVote(const std::vector<std::pair<float, ClassId>>& distances, size_t k, size_t numClasses) {
+        std::vector<size_t> classCounts(numClasses, 0);
+        for (size_t i = 0; i < k && i < distances.size(); ++i) {
+            classCounts[distances[i].second]++;
+        }
+
+        ClassId mostCommonClass = DataSet::NO_CLASS;
+        size_t highestCount = 0;
+        for (size_t c = 0; c < classCounts.size(); ++c) {
+            if (classCounts[c] > highestCount) {
+                highestCount = classCounts[c];
+                mostCommonClass = static_cast<ClassId>(c);
+            }
+        }
+        return mostCommonClass;
+    }
+}
 
 KNNClassifier::KNNClassifier(const DataSet& originalTrainingData, size_t k) : trainingData(originalTrainingData), k(k) {}
 
@@ -15,67 +33,31 @@ size_t KNNClassifier::getK() const {
     return k;
 }
 
-std::string KNNClassifier::classify(const DataItem& testItem, const Solution& solution) const {
-    std::vector<std::pair<float, std::string>> distances(trainingData.items.size());
+ClassId KNNClassifier::classify(const DataRow& testRow, const Solution& solution) const {
+    std::vector<std::pair<float, ClassId>> distances(trainingData.size());
     
-    #pragma omp parallel for
-    for (size_t i = 0; i < static_cast<size_t>(trainingData.items.size()); ++i) {
-        const auto& item = trainingData.items[i];
-        float dist = MathUtils::weightedEuclideanDistance(item.features, testItem.features, solution.weights);
-        distances[i] = {dist, item.label};
+    for (size_t i = 0; i < trainingData.size(); ++i) {
+        float dist = MathUtils::weightedEuclideanDistance(trainingData.row(i).features, testRow.features, solution.weights.data(), testRow.size());
+        distances[i] = {dist, trainingData.getClassId(i)};
     }
     
     std::sort(distances.begin(), distances.end());
-    std::unordered_map<std::string, size_t> labelCounts;
-    for (size_t i = 0; i < k && i < distances.size(); ++i) {
-        labelCounts[distances[i].second]++;
-    }
-
-    std::string mostCommonLabel;
-    size_t highestCount = 0;
-    for (const auto& pair : labelCounts) {
-        if (pair.second > highestCount) {
-            highestCount = pair.second;
-            mostCommonLabel = pair.first;
-        }
-    }
-
-    return mostCommonLabel;
+    return majorityVote(distances, k, trainingData.getNumClasses());
 }
 
-std::string KNNClassifier::classifyExcludingIndex(const DataItem& item, size_t excludeIndex, const Solution& solution) {
-    std::vector<std::pair<float, std::string>> distances;
-    
-    #pragma omp parallel
-    {
-        std::vector<std::pair<float, std::string>> local_distances;
-        #pragma omp for nowait
-        for (size_t i = 0; i < trainingData.items.size(); ++i) {
-            if (i == excludeIndex) {
-                continue;
-            }
-            float dist = MathUtils::calculateDistance(trainingData.items[i].features, item.features, solution.weights);
-            local_distances.emplace_back(dist, trainingData.items[i].label);
+ClassId KNNClassifier::classifyExcludingIndex(const DataRow& row, size_t excludeIndex, const Solution& solution) {
+    std::vector<std::pair<float, ClassId>> distances;
+    distances.reserve(trainingData.size());
+
+    for (size_t i = 0; i < trainingData.size(); ++i) {
+        if (i == excludeIndex) {
+            continue;
         }
-        #pragma omp critical
-        distances.insert(distances.end(), local_distances.begin(), local_distances.end());
+        float dist = MathUtils::calculateDistance(trainingData.row(i).features, row.features, solution.weights.data(), row.size());
+        distances.emplace_back(dist, trainingData.getClassId(i));
     }
     
     std::sort(distances.begin(), distances.end());
 
-    std::unordered_map<std::string, size_t> labelCounts;
-    for (size_t i = 0; i < k && i < distances.size(); ++i) {
-        labelCounts[distances[i].second]++;
-    }
-
-    std::string mostCommonLabel;
-    size_t highestCount = 0;
-    for (const auto& pair : labelCounts) {
-        if (pair.second > highestCount) {
-            highestCount = pair.second;
-            mostCommonLabel = pair.first;
-        }
-    }
-
-    return mostCommonLabel;
+    return majorityVote(distances, k, trainingData.getNumClasses());
 }
@@ -10,7 +10,12 @@
 LocalSearch::LocalSearch(std::shared_ptr<Evaluation> eval, size_t maxNeighbors, 
     size_t maxEvaluations, float mean, float variance) : eval(eval), 
     maxNeighbors(maxNeighbors), maxEvaluations(maxEvaluations), 
-    std(std::sqrt(variance)) {}
+    mean(mean), std(std::sqrt(variance)) {}
+
+IncrementalEvaluator& LocalSearch::incrementalFor(const DataSet& dataset) {
+    incremental = std::make_unique<IncrementalEvaluator>(eval, dataset);
+    return *incremental;
+}
 
 Solution LocalSearch::generateNeighbor(const Solution& solution, size_t index) {
     Solution neighbor = solution;
@@ -22,7 +27,8 @@ Solution LocalSearch::generateNeighbor(const Solution& solution, size_t index) {
 EvaluatedSolution LocalSearch::run(Solution solution, const DataSet& dataset) {
     size_t n = dataset.getNumFeatures();
     Solution currentSolution = solution;
-    float currentFitness = eval->calculateFitnessLeaveOneOut(dataset, currentSolution);
+    IncrementalEvaluator& evaluator = incrementalFor(dataset);
+    float currentFitness = evaluator.reset(currentSolution);
 
     size_t maxNumNeighbors = maxNeighbors * n; 
     size_t numNeighbors = 0;
@@ -32,13 +38,16 @@ EvaluatedSolution LocalSearch::run(Solution solution, const DataSet& dataset) {
 
         for (size_t i = 0; i < indices.size(); ++i) {
             Solution neighbor = generateNeighbor(currentSolution, indices[i]);
-            float fitness = eval->calculateFitnessLeaveOneOut(dataset, neighbor);
+            float fitness = evaluator.propose(neighbor, indices[i]);
             evaluations++;
             numNeighbors++;
 
             if (fitness > currentFitness) {
                 currentSolution = neighbor;
                 currentFitness = fitness;
+                evaluator.commit();
+            } else {
+                evaluator.rollback();
             }
         }
     }
@@ -49,7 +58,8 @@ EvaluatedSolution LocalSearch::run(Solution solution, const DataSet& dataset) {
 EvaluatedSolution LocalSearch::run(const DataSet& dataset) {
     size_t n = dataset.getNumFeatures();
     Solution currentSolution(n);
-    float currentFitness = eval->calculateFitnessLeaveOneOut(dataset, currentSolution);
+    IncrementalEvaluator& evaluator = incrementalFor(dataset);
+    float currentFitness = evaluator.reset(currentSolution);
 
     size_t maxNumNeighbors = maxNeighbors * n; 
     size_t numNeighbors = 0;
@@ -60,7 +70,7 @@ EvaluatedSolution LocalSearch::run(const DataSet& dataset) {
 
         for (size_t i = 0; i < indices.size() && !improved; ++i) {
             Solution neighbor = generateNeighbor(currentSolution, indices[i]);
-            float fitness = eval->calculateFitnessLeaveOneOut(dataset, neighbor);
+            float fitness = evaluator.propose(neighbor, indices[i]);
             eval->insertFitnessRecord(currentFitness);
             evaluations++;
 
@@ -69,6 +79,9 @@ EvaluatedSolution LocalSearch::run(const DataSet& dataset) {
                 currentFitness = fitness;
                 improved = true;
                 numNeighbors = 0;
+                evaluator.commit();
+            } else {
+                evaluator.rollback();
             }
         }
 
@@ -83,7 +96,8 @@ EvaluatedSolution LocalSearch::run(const DataSet& dataset) {
 EvaluatedSolution LocalSearch::runTrayectories(Solution solution, const DataSet& dataset) {
     size_t n = dataset.getNumFeatures();
     Solution currentSolution = solution;
-    float currentFitness = eval->calculateFitnessLeaveOneOut(dataset, currentSolution);
+    IncrementalEvaluator& evaluator = incrementalFor(dataset);
+    float currentFitness = evaluator.reset(currentSolution);
 
     size_t maxNumNeighbors = maxNeighbors * n; 
     size_t numNeighbors = 0;
@@ -94,7 +108,7 @@ EvaluatedSolution LocalSearch::runTrayectories(Solution solution, const DataSet&
 
         for (size_t i = 0; i < indices.size() && !improved; ++i) {
             Solution neighbor = generateNeighbor(currentSolution, indices[i]);
-            float fitness = eval->calculateFitnessLeaveOneOut(dataset, neighbor);
+            float fitness = evaluator.propose(neighbor, indices[i]);
             eval->insertFitnessRecord(currentFitness);
             evaluations++;
 
@@ -103,6 +117,9 @@ EvaluatedSolution LocalSearch::runTrayectories(Solution solution, const DataSet&
                 currentFitness = fitness;
                 improved = true;
                 numNeighbors = 0;
+                evaluator.commit();
+            } else {
+                evaluator.rollback();
             }
         }
 
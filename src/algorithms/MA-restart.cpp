@@ -2,19 +2,13 @@
 
 #include <algorithm>
 
-float MemeticRestart::calculateVariance(const std::vector<Solution>& population, size_t i) {
-    float mean = 0;
-    for (size_t j = 0; j < population.size(); ++j) {
-        mean += population[j].getWeight(i);
-    }
-    mean /= population.size();
-
-    float variance = 0;
-    for (size_t j = 0; j < population.size(); ++j) {
-        variance += (population[j].getWeight(i) - mean) * (population[j].getWeight(i) - mean);
+float MemeticRestart::calculateVariance(const PopulationMatrix& population) {
+    std::vector<float> variances = population.weightVariances();
+    float meanVariance = 0;
+    for (float variance : variances) {
+        meanVariance += variance;
     }
-    variance /= population.size();
-    return variance;
+    return meanVariance / population.getNumWeights();
 }
 
 EvaluatedSolution MemeticRestart::run(const DataSet& dataset) {
@@ -23,11 +17,10 @@ EvaluatedSolution MemeticRestart::run(const DataSet& dataset) {
     float meanVariance = 0;
     
     // Initialize and evaluate initial population
-    std::vector<Solution> population = ga->initialize_population(dataset.getNumFeatures());
-    populationFitness = ga->evaluatePopulation(population, dataset);
+    PopulationMatrix population = ga->initialize_population(dataset.getNumFeatures());
+    ga->evaluatePopulation(population, dataset);
     evaluations += ga->getEvaluations();
     ga->clearEvaluations();
-    ga->setPopulationFitness(populationFitness);
     
     // Initial optimization
     optimize_population(population, dataset);
@@ -35,52 +28,45 @@ EvaluatedSolution MemeticRestart::run(const DataSet& dataset) {
     ls->clearEvaluations();
     
     // Re-evaluate population after optimization and update fitness
-    populationFitness = ga->evaluatePopulation(population, dataset);
+    ga->evaluatePopulation(population, dataset);
     evaluations += ga->getEvaluations();
     ga->clearEvaluations();
-    ga->setPopulationFitness(populationFitness);
     
-    eval->insertFitnessRecord(*std::max_element(populationFitness.begin(), populationFitness.end()));
+    eval->insertFitnessRecord(population.getFitness()[population.bestIndex()]);
 
+    PopulationMatrix offspring;
     while (evaluations < maxEvaluations) {
-        meanVariance = 0;
-        for (size_t i = 0; i < static_cast<size_t>(dataset.getNumFeatures()); ++i) {
-            meanVariance += calculateVariance(population, i);
-        }
-        meanVariance /= dataset.getNumFeatures();
+        meanVariance = calculateVariance(population);
 
         if (meanVariance < restartFrequency) {
             std::cout << "Restarting population: " << generation << std::endl;
             // Store best solution before restart
-            auto bestIt = std::max_element(populationFitness.begin(), populationFitness.end());
-            Solution bestSolution = population[std::distance(populationFitness.begin(), bestIt)];
+            Solution bestSolution = population.getSolution(population.bestIndex());
             
             // Reinitialize population and preserve best solution
             population = ga->initialize_population(dataset.getNumFeatures());
-            population[0] = bestSolution;
+            population.setSolution(0, bestSolution);
             
             // Evaluate new population
-            populationFitness = ga->evaluatePopulation(population, dataset);
+            ga->evaluatePopulation(population, dataset);
             evaluations += ga->getEvaluations();
             ga->clearEvaluations();
-            ga->setPopulationFitness(populationFitness);
             meanVariance = 0;
             continue;  // Skip to next iteration to avoid duplicate evolution step
         }
 
         // Evolution step
-        std::vector<Solution> selected = ga->select_for_reproduction(population);
-        std::vector<Solution> offspring = ga->recombine_population(selected);
-        offspring = ga->mutate_population(offspring);
+        std::vector<size_t> parents = ga->select_for_reproduction(population);
+        ga->recombine_population(population, parents, offspring);
+        ga->mutate_population(offspring);
         
         // Evaluate offspring and perform replacement
-        std::vector<float> offspringFitness = ga->evaluatePopulation(offspring, dataset);
+        ga->evaluatePopulation(offspring, dataset);
         evaluations += ga->getEvaluations();
         ga->clearEvaluations();
         
         // Replace population and update fitness
         ga->replace_population(population, offspring, dataset);
-        populationFitness = ga->getPopulationFitness();
         
         // Local search step
         if (generation % optimizationFrequency == 0) {
@@ -89,17 +75,15 @@ EvaluatedSolution MemeticRestart::run(const DataSet& dataset) {
             ls->clearEvaluations();
             
             // Re-evaluate population after optimization
-            populationFitness = ga->evaluatePopulation(population, dataset);
+            ga->evaluatePopulation(population, dataset);
             evaluations += ga->getEvaluations();
             ga->clearEvaluations();
-            ga->setPopulationFitness(populationFitness);
         }
 
-        eval->insertFitnessRecord(*std::max_element(populationFitness.begin(), populationFitness.end()));
+        eval->insertFitnessRecord(population.getFitness()[population.bestIndex()]);
         ++generation;
     }
 
-    auto bestIt = std::max_element(populationFitness.begin(), populationFitness.end());
-    size_t bestIndex = std::distance(populationFitness.begin(), bestIt);
-    return EvaluatedSolution{population[bestIndex], populationFitness[bestIndex]};
+    size_t bestIndex = population.bestIndex();
+    return EvaluatedSolution{population.getSolution(bestIndex), population.getFitness()[bestIndex]};
 }
\ No newline at end of file
@@ -15,8 +15,8 @@ EvaluatedSolution MemeticAlgorithm::run(const DataSet& dataset) {
     size_t generation = 0;
     
     // Initialize and evaluate initial population
-    std::vector<Solution> population = ga->initialize_population(dataset.getNumFeatures());
-    populationFitness = ga->evaluatePopulation(population, dataset);
+    PopulationMatrix population = ga->initialize_population(dataset.getNumFeatures());
+    ga->evaluatePopulation(population, dataset);
     evaluations += ga->getEvaluations();
     ga->clearEvaluations();
     
@@ -26,19 +26,14 @@ EvaluatedSolution MemeticAlgorithm::run(const DataSet& dataset) {
     ls->clearEvaluations();
     
     // Re-evaluate population after optimization
-    populationFitness = ga->evaluatePopulation(population, dataset);
+    ga->evaluatePopulation(population, dataset);
     evaluations += ga->getEvaluations();
     ga->clearEvaluations();
     
-    ga->setPopulationFitness(populationFitness);
-    eval->insertFitnessRecord(*std::max_element(populationFitness.begin(), populationFitness.end()));
+    eval->insertFitnessRecord(population.getFitness()[population.bestIndex()]);
 
     while (evaluations < maxEvaluations) {
-        std::vector<Solution> selected = ga->select_for_reproduction(population);
-        std::vector<Solution> offspring = ga->recombine_population(selected);
-        offspring = ga->mutate_population(offspring);
-        
-        ga->replace_population(population, offspring, dataset);
+        ga->runGeneration(population, dataset);
         evaluations += ga->getEvaluations();
         ga->clearEvaluations();
         
@@ -48,18 +43,17 @@ EvaluatedSolution MemeticAlgorithm::run(const DataSet& dataset) {
             ls->clearEvaluations();
         }
 
-        populationFitness = ga->getPopulationFitness();
-        eval->insertFitnessRecord(*std::max_element(populationFitness.begin(), populationFitness.end()));
+        eval->insertFitnessRecord(population.getFitness()[population.bestIndex()]);
         ++generation;
     }
 
     // Find the best solution in the population
-    size_t bestIndex = std::distance(populationFitness.begin(), 
-                                   std::max_element(populationFitness.begin(), populationFitness.end()));
-    return EvaluatedSolution{population[bestIndex], populationFitness[bestIndex]};
+    size_t bestIndex = population.bestIndex();
+    return EvaluatedSolution{population.getSolution(bestIndex), population.getFitness()[bestIndex]};
 }
 
-void MemeticAlgorithm::optimize_population(std::vector<Solution>& population, const DataSet& dataset) {
+void MemeticAlgorithm::optimize_population(PopulationMatrix& population, const DataSet& dataset) {
+    std::vector<float>& populationFitness = population.getFitness();
     size_t numToSelect = static_cast<size_t>(selectionRate * population.size());
     size_t numElitist = static_cast<size_t>(elitismRate * numToSelect);
     size_t numRandom = numToSelect - numElitist;
@@ -79,8 +73,8 @@ void MemeticAlgorithm::optimize_population(std::vector<Solution>& population, co
 
     // Optimize the selected individuals using local search
     for (size_t index : selectedIndices) {
-        EvaluatedSolution optimized = ls->run(population[index], dataset);
-        population[index] = optimized.solution;
+        EvaluatedSolution optimized = ls->run(population.getSolution(index), dataset);
+        population.setSolution(index, optimized.solution);
         populationFitness[index] = optimized.fitness;
     }
 }
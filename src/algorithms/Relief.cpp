@@ -1,32 +1,99 @@
 #include "algorithms/Relief.hpp"
 #include "utils/MathUtils.hpp"
-#include "data/DataItem.hpp"
 #include "data/DataSet.hpp"
 #include <limits>
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Adds sign * |a[k] - b[k]| to every weight, visiting only the features stored in either row.
+    void addAbsoluteDifferences(const SparseRow& a, const SparseRow& b, float sign, std::vector<float>& weights) {
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size()) {
+            uint32_t indexA = i < a.size() ? a.indices[i] : std::numeric_limits<uint32_t>::max();
+            uint32_t indexB = j < b.size() ? b.indices[j] : std::numeric_limits<uint32_t>::max();
+            uint32_t index = std::min(indexA, indexB);
+            float valueA = indexA == index ? a.values[i++] : 0.0f;
+            float valueB = indexB == index ? b.values[j++] : 0.0f;
+            weights[index] += sign * std::abs(valueA - valueB);
+        }
+    }
+
+    // Relief on sparse rows, with squared distances, which pick the same neighbors.
+    void runSparse(const DataSet& dataset, std::vector<float>& weights) {
+        std::vector<float> unitWeights(weights.size(), 1.0f);
+        std::vector<float> norms(dataset.size());
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            norms[i] = MathUtils::weightedSquaredNorm(dataset.sparseRow(i), unitWeights.data());
+        }
+
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            SparseRow instance = dataset.sparseRow(i);
+            ClassId label = dataset.getClassId(i);
+            size_t closestFriend = 0, closestEnemy = 0;
+            bool foundFriend = false, foundEnemy = false;
+            float closestFriendDist = std::numeric_limits<float>::max();
+            float closestEnemyDist = std::numeric_limits<float>::max();
+
+            for (size_t j = 0; j < dataset.size(); ++j) {
+                if (i == j) {
+                    continue;
+                }
+                float dist = MathUtils::weightedSquaredEuclideanDistance(instance, dataset.sparseRow(j), unitWeights.data(),
+                                                                         norms[i], norms[j]);
+                bool sameClass = label == dataset.getClassId(j);
+                if (sameClass && dist < closestFriendDist) {
+                    closestFriend = j;
+                    closestFriendDist = dist;
+                    foundFriend = true;
+                } else if (!sameClass && dist < closestEnemyDist) {
+                    closestEnemy = j;
+                    closestEnemyDist = dist;
+                    foundEnemy = true;
+                }
+            }
+
+            if (foundFriend && foundEnemy) {
+                addAbsoluteDifferences(instance, dataset.sparseRow(closestEnemy), 1.0f, weights);
+                addAbsoluteDifferences(instance, dataset.sparseRow(closestFriend), -1.0f, weights);
+            }
+        }
+    }
+}
 
 Relief::Relief(std::shared_ptr<Evaluation> eval) : eval(eval) {}
 
 EvaluatedSolution Relief::run(const DataSet& dataset) {
-    Solution solution(dataset.getNumFeatures(), 0.0f);
+    size_t numFeatures = dataset.getNumFeatures();
+    Solution solution(numFeatures, 0.0f);
+
+    if (dataset.isSparse()) {
+        runSparse(dataset, solution.weights);
+        MathUtils::normalizeWeights(solution.weights);
+        return eval->evaluate(solution, dataset);
+    }
 
-    for (const auto& instance : dataset.items) {
+    for (size_t i = 0; i < dataset.size(); ++i) {
+        DataRow instance = dataset.row(i);
+        ClassId label = dataset.getClassId(i);
+        size_t closestFriend = 0, closestEnemy = 0;
         bool foundFriend = false, foundEnemy = false;
-        DataItem closestFriend, closestEnemy;
         float closestFriendDist = std::numeric_limits<float>::max();
         float closestEnemyDist = std::numeric_limits<float>::max();
 
-        for (const auto& other : dataset.items) {
-            if (&instance != &other) {
+        for (size_t j = 0; j < dataset.size(); ++j) {
+            if (i != j) {
             
-            float dist = MathUtils::euclideanDistance(instance.features, other.features);
-            if (instance.label == other.label && dist < closestFriendDist) {
-                closestFriend = other;
+            float dist = MathUtils::euclideanDistance(instance.features, dataset.row(j).features, numFeatures);
+            bool sameClass = label == dataset.getClassId(j);
+            if (sameClass && dist < closestFriendDist) {
+                closestFriend = j;
                 closestFriendDist = dist;
                 foundFriend = true;
-            } else if (instance.label != other.label && dist < closestEnemyDist) {
-                closestEnemy = other;
+            } else if (!sameClass && dist < closestEnemyDist) {
+                closestEnemy = j;
                 closestEnemyDist = dist;
                 foundEnemy = true;
             }
@@ -34,10 +101,12 @@ EvaluatedSolution Relief::run(const DataSet& dataset) {
         }
 
         if (foundFriend && foundEnemy) {
-            for (size_t i = 0; i < solution.weights.size(); ++i) {
-                float diffEnemy = std::abs(instance.features[i] - closestEnemy.features[i]);
-                float diffFriend = std::abs(instance.features[i] - closestFriend.features[i]);
-                solution.weights[i] += diffEnemy - diffFriend;
+            DataRow enemy = dataset.row(closestEnemy);
+            DataRow friendRow = dataset.row(closestFriend);
+            for (size_t k = 0; k < solution.weights.size(); ++k) {
+                float diffEnemy = std::abs(instance[k] - enemy[k]);
+                float diffFriend = std::abs(instance[k] - friendRow[k]);
+                solution.weights[k] += diffEnemy - diffFriend;
             }
         }
     }
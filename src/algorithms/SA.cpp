@@ -9,15 +9,20 @@
 SA::SA(std::shared_ptr<Evaluation> eval, size_t maxEvaluations, float finalTemperature, float acceptanceProbability, float worseningProbability)
      : eval(eval), maxEvaluations(maxEvaluations), finalTemperature(finalTemperature), acceptanceProbability(acceptanceProbability), worseningProbability(worseningProbability) {}
 
-Solution SA::generateNeighbor(const Solution& solution) {
+Solution SA::generateNeighbor(const Solution& solution, size_t& index) {
     Solution neighbor = solution;
     size_t n = solution.size();
-    size_t index = RandomUtils::getRandomInt(0, n - 1);
+    index = RandomUtils::getRandomInt(0, n - 1);
     neighbor.weights.at(index) += RandomUtils::getRandomNormal(0.0f, std::sqrt(0.3f));
     neighbor.weights.at(index) = std::clamp(neighbor.weights.at(index), 0.0f, 1.0f);
     return neighbor;
 }
 
+IncrementalEvaluator& SA::incrementalFor(const DataSet& dataset) {
+    incremental = std::make_unique<IncrementalEvaluator>(eval, dataset);
+    return *incremental;
+}
+
 EvaluatedSolution SA::run(const DataSet& dataset) {
     Solution initialSolution(dataset.getNumFeatures());
     return run(initialSolution, dataset);
@@ -30,7 +35,8 @@ EvaluatedSolution SA::run(const Solution& initialSolution, const DataSet& datase
     const size_t M = maxEvaluations / maxNeighbors;
 
     Solution currentSolution = initialSolution;
-    float currentFitness = eval->calculateFitnessLeaveOneOut(dataset, currentSolution);
+    IncrementalEvaluator& evaluator = incrementalFor(dataset);
+    float currentFitness = evaluator.reset(currentSolution);
     Solution bestSolution = currentSolution;
     float bestFitness = currentFitness;
 
@@ -51,8 +57,9 @@ EvaluatedSolution SA::run(const Solution& initialSolution, const DataSet& datase
         size_t numNeighbors = 0;
 
         while (numSuccess < maxSuccess && numNeighbors < maxNeighbors && numEvaluations < maxEvaluations) {
-            Solution neighbor = generateNeighbor(currentSolution);
-            float neighborFitness = eval->calculateFitnessLeaveOneOut(dataset, neighbor);
+            size_t index;
+            Solution neighbor = generateNeighbor(currentSolution, index);
+            float neighborFitness = evaluator.propose(neighbor, index);
             float delta = currentFitness - neighborFitness;
             numNeighbors++;
             numEvaluations++;
@@ -61,11 +68,14 @@ EvaluatedSolution SA::run(const Solution& initialSolution, const DataSet& datase
                 currentSolution = neighbor;
                 currentFitness = neighborFitness;
                 numSuccess++;
+                evaluator.commit();
 
                 if (currentFitness > bestFitness) {
                     bestSolution = currentSolution;
                     bestFitness = currentFitness;
                 }
+            } else {
+                evaluator.rollback();
             }
         }
 
@@ -2,33 +2,28 @@
 #include "utils/RandomUtils.hpp"
 #include <algorithm>
 
-std::vector<Solution> SGAAC::select_for_reproduction(const std::vector<Solution>& population) {
+std::vector<size_t> SGAAC::select_for_reproduction(const PopulationMatrix& population) {
     return tournament_selection(population, 2, 3);
 }
 
-std::vector<Solution> SGAAC::mutate_population(const std::vector<Solution>& population) {
-    std::vector<Solution> mutated;
-    mutated.reserve(population.size());
-
-    for (const auto& solution : population) {
-        Solution newSolution(solution.size());
+void SGAAC::mutate_population(PopulationMatrix& population) {
+    size_t numWeights = population.getNumWeights();
+    for (size_t i = 0; i < population.size(); ++i) {
         if (RandomUtils::getRandomFloat(0.0, 1.0) < mutationRate) {
-            size_t geneIndex = RandomUtils::getRandomInt(0, solution.size() - 1);
-            newSolution.weights[geneIndex] += RandomUtils::getRandomNormal(mean, std);
-            newSolution.weights[geneIndex] = std::clamp(newSolution.weights[geneIndex], 0.0f, 1.0f);
-        } else {
-            newSolution = solution;
+            float* weights = population.row(i);
+            size_t geneIndex = RandomUtils::getRandomInt(0, numWeights - 1);
+            weights[geneIndex] += RandomUtils::getRandomNormal(mean, std);
+            weights[geneIndex] = std::clamp(weights[geneIndex], 0.0f, 1.0f);
         }
-        mutated.push_back(newSolution);
     }
-
-    return mutated;
 }
 
-std::vector<Solution> SGAAC::recombine_population(const std::vector<Solution>& population) {
-    return arithmetic_crossover(population[0], population[1]);
+void SGAAC::recombine_population(const PopulationMatrix& population, const std::vector<size_t>& parents, PopulationMatrix& offspring) {
+    size_t numWeights = population.getNumWeights();
+    offspring.resize(2, numWeights);
+    arithmetic_crossover(population.row(parents[0]), population.row(parents[1]), offspring.row(0), offspring.row(1), numWeights);
 }
 
-void SGAAC::replace_population(std::vector<Solution>& population, std::vector<Solution>& newPopulation, const DataSet& dataset) {
+void SGAAC::replace_population(PopulationMatrix& population, PopulationMatrix& newPopulation, const DataSet& dataset) {
     competitive_replacement(population, newPopulation, dataset);
 }
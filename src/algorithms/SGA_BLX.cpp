@@ -2,33 +2,28 @@
 #include "utils/RandomUtils.hpp"
 #include <algorithm>
 
-std::vector<Solution> SGABLX::select_for_reproduction(const std::vector<Solution>& population) {
+std::vector<size_t> SGABLX::select_for_reproduction(const PopulationMatrix& population) {
     return tournament_selection(population, 2, 3);
 }
 
-std::vector<Solution> SGABLX::mutate_population(const std::vector<Solution>& population) {
-    std::vector<Solution> mutated;
-    mutated.reserve(population.size());
-
-    for (const auto& solution : population) {
-        Solution newSolution(solution.size());
+void SGABLX::mutate_population(PopulationMatrix& population) {
+    size_t numWeights = population.getNumWeights();
+    for (size_t i = 0; i < population.size(); ++i) {
         if (RandomUtils::getRandomFloat(0.0, 1.0) < mutationRate) {
-            size_t geneIndex = RandomUtils::getRandomInt(0, solution.size() - 1);
-            newSolution.weights[geneIndex] += RandomUtils::getRandomNormal(mean, std);
-            newSolution.weights[geneIndex] = std::clamp(newSolution.weights[geneIndex], 0.0f, 1.0f);
-        } else {
-            newSolution = solution;
+            float* weights = population.row(i);
+            size_t geneIndex = RandomUtils::getRandomInt(0, numWeights - 1);
+            weights[geneIndex] += RandomUtils::getRandomNormal(mean, std);
+            weights[geneIndex] = std::clamp(weights[geneIndex], 0.0f, 1.0f);
         }
-        mutated.push_back(newSolution);
     }
-
-    return mutated;
 }
 
-std::vector<Solution> SGABLX::recombine_population(const std::vector<Solution>& population) {
-    return blend_crossover(population[0], population[1], 0.3);
+void SGABLX::recombine_population(const PopulationMatrix& population, const std::vector<size_t>& parents, PopulationMatrix& offspring) {
+    size_t numWeights = population.getNumWeights();
+    offspring.resize(2, numWeights);
+    blend_crossover(population.row(parents[0]), population.row(parents[1]), offspring.row(0), offspring.row(1), numWeights, 0.3f);
 }
 
-void SGABLX::replace_population(std::vector<Solution>& population, std::vector<Solution>& newPopulation, const DataSet& dataset) {
+void SGABLX::replace_population(PopulationMatrix& population, PopulationMatrix& newPopulation, const DataSet& dataset) {
     competitive_replacement(population, newPopulation, dataset);
 }
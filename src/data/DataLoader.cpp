@@ -1,12 +1,21 @@
 #include "data/DataLoader.hpp"
+#include "utils/GzipStream.hpp"
+#include "utils/MappedFile.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <charconv>
 #include <cctype>
 #include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <omp.h>
+#include <unordered_map>
 
 std::string toLowerCase(const std::string& str) {
     std::string lowerStr = str;
@@ -26,31 +35,499 @@ std::string normalizeClassLabel(const std::string& classLabel) {
     return classLabel;
 }
 
-namespace DataLoader {
-    bool readARFF(const std::string& filename, DataSet& dataset) {
-        std::ifstream file(filename);
-        std::string line;
-        bool isDataSection = false;
+namespace {
+    bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
 
-        if (!file.is_open()) {
-            std::cerr << "Unable to open file: " << filename << std::endl;
-            return false;
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && isBlank(text.front())) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && isBlank(text.back())) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    bool containsIgnoreCase(std::string_view text, std::string_view lowerNeedle) {
+        auto it = std::search(text.begin(), text.end(), lowerNeedle.begin(), lowerNeedle.end(),
+                              [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+        return it != text.end();
+    }
+
+    // Parses a feature value the way std::stof reads its leading number.
+    bool parseFeature(std::string_view text, float& value) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+            text.remove_prefix(1);
+        }
+        if (text.size() > 1 && text.front() == '+' && text[1] != '-') {
+            text.remove_prefix(1);
+        }
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc();
+    }
+
+    // Resolves raw class labels, remembering the few distinct ones seen. Labels
+    // are looked up in a declared class table, or discovered in order of first
+    // appearance, in which case the local index of the label is returned.
+    class LabelResolver {
+    private:
+        const DataSet* declared;
+        std::vector<std::pair<std::string, ClassId>> known;
+        std::vector<std::string> discovered;
+        std::string raw;
+
+    public:
+        explicit LabelResolver(const DataSet* declared) : declared(declared) {}
+
+        const std::vector<std::string>& getDiscovered() const { return discovered; }
+
+        ClassId resolve(std::string_view rawLabel) {
+            raw.assign(rawLabel);
+            if (declared != nullptr) {
+                std::transform(raw.begin(), raw.end(), raw.begin(), [](unsigned char c) { return std::tolower(c); });
+            }
+            for (const auto& entry : known) {
+                if (entry.first == raw) {
+                    return entry.second;
+                }
+            }
+
+            std::string classLabel = normalizeClassLabel(raw);
+            ClassId classId = DataSet::NO_CLASS;
+            if (declared != nullptr) {
+                classId = declared->getClassId(classLabel);
+            } else {
+                auto it = std::find(discovered.begin(), discovered.end(), classLabel);
+                classId = static_cast<ClassId>(it - discovered.begin());
+                if (it == discovered.end()) {
+                    discovered.push_back(classLabel);
+                }
+            }
+            known.emplace_back(raw, classId);
+            return classId;
+        }
+
+        std::string describe(std::string_view rawLabel) const {
+            std::string label(rawLabel);
+            if (declared != nullptr) {
+                label = toLowerCase(label);
+            }
+            return normalizeClassLabel(label);
+        }
+    };
+
+    // Returns the next line of [cursor, end) without its blanks and moves cursor past it.
+    std::string_view nextLine(const char*& cursor, const char* end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* lineEnd = newline != nullptr ? newline : end;
+        std::string_view line = trim(std::string_view(cursor, lineEnd - cursor));
+        cursor = newline != nullptr ? newline + 1 : end;
+        return line;
+    }
+
+    // Splits a data row into its feature values, parsed into features, and its raw label.
+    std::string_view splitRow(std::string_view line, std::vector<float>& features, std::string& messages) {
+        // The last value is the class label; a trailing comma does not start a new value
+        std::string_view values = line.back() == ',' ? line.substr(0, line.size() - 1) : line;
+        size_t labelComma = values.rfind(',');
+        std::string_view rawLabel = labelComma == std::string_view::npos ? values : values.substr(labelComma + 1);
+
+        features.clear();
+        size_t fieldStart = 0;
+        while (labelComma != std::string_view::npos && fieldStart <= labelComma) {
+            size_t comma = values.find(',', fieldStart);
+            std::string_view field = values.substr(fieldStart, comma - fieldStart);
+            float value;
+            if (parseFeature(field, value)) {
+                features.push_back(value);
+            } else {
+                messages.append("Invalid feature value: ").append(field).append("\n");
+            }
+            fieldStart = comma + 1;
+        }
+        return rawLabel;
+    }
+
+    // A keyword line starts with '@'; lines come trimmed, so that is its first non-blank character.
+    bool isKeyword(std::string_view line) {
+        return !line.empty() && line[0] == '@';
+    }
+
+    // Comments, blank lines and keyword lines carry no data row.
+    bool isDataRow(std::string_view line) {
+        return !line.empty() && line[0] != '%' && !isKeyword(line);
+    }
+
+    // The rows of one chunk of a data section, with the bounds of their features.
+    struct ParsedChunk {
+        std::vector<float> features; /**< The accepted rows, numFeatures values each. */
+        std::vector<ClassId> labels; /**< The declared ClassId, or the discovered label index, of every row. */
+        std::vector<std::string> discovered; /**< The labels discovered in the chunk, by local index. */
+        std::vector<float> min; /**< The minimum of every feature over the rows. */
+        std::vector<float> max; /**< The maximum of every feature over the rows. */
+        std::string messages; /**< The errors found, in line order. */
+    };
+
+    void parseChunk(const char* cursor, const char* end, size_t numFeatures, const DataSet* declared, ParsedChunk& chunk) {
+        LabelResolver labels(declared);
+        std::vector<float> features;
+        chunk.min.assign(numFeatures, std::numeric_limits<float>::max());
+        chunk.max.assign(numFeatures, std::numeric_limits<float>::lowest());
+
+        while (cursor < end) {
+            std::string_view line = nextLine(cursor, end);
+            if (!isDataRow(line)) {
+                continue;
+            }
+
+            std::string_view rawLabel = splitRow(line, features, chunk.messages);
+            ClassId classId = labels.resolve(rawLabel);
+            if (classId == DataSet::NO_CLASS) {
+                chunk.messages.append("Error: Class label '").append(labels.describe(rawLabel))
+                              .append("' does not exist in the dataset's known classes.\n");
+                continue;
+            }
+            if (features.size() != numFeatures) {
+                chunk.messages.append("Error: Data item has ").append(std::to_string(features.size()))
+                              .append(" features, expected ").append(std::to_string(numFeatures)).append(".\n");
+                continue;
+            }
+
+            for (size_t k = 0; k < numFeatures; ++k) {
+                chunk.min[k] = std::min(chunk.min[k], features[k]);
+                chunk.max[k] = std::max(chunk.max[k], features[k]);
+            }
+            chunk.features.insert(chunk.features.end(), features.begin(), features.end());
+            chunk.labels.push_back(classId);
+        }
+        chunk.discovered = labels.getDiscovered();
+    }
+
+    // Returns the number of features of the first row with a valid label, which fixes the row length.
+    size_t findRowLength(const char* cursor, const char* end, const DataSet* declared) {
+        LabelResolver labels(declared);
+        std::vector<float> features;
+        std::string messages;
+        while (cursor < end) {
+            std::string_view line = nextLine(cursor, end);
+            if (isDataRow(line) && labels.resolve(splitRow(line, features, messages)) != DataSet::NO_CLASS) {
+                return features.size();
+            }
+        }
+        return 0;
+    }
+
+    // Splits [begin, end) into newline-aligned chunks, one per thread if they are large enough.
+    std::vector<const char*> splitChunks(const char* begin, const char* end) {
+        size_t bytes = end - begin;
+        size_t numChunks = std::clamp<size_t>(bytes / DataLoader::MIN_PARALLEL_CHUNK_BYTES, 1, omp_get_max_threads());
+        std::vector<const char*> bounds(numChunks + 1, end);
+        bounds[0] = begin;
+        for (size_t c = 1; c < numChunks; ++c) {
+            const char* target = std::max(bounds[c - 1], begin + bytes * c / numChunks);
+            const char* newline = static_cast<const char*>(std::memchr(target, '\n', end - target));
+            bounds[c] = newline != nullptr ? newline + 1 : end;
+        }
+        return bounds;
+    }
+
+    // Parses the data rows of [begin, end) in newline-aligned chunks, one per
+    // thread, and appends them to the dataset in file order. Labels are looked
+    // up in the class table of the dataset or, when discoverLabels is set,
+    // added to it in order of first appearance. The feature bounds of the
+    // dataset are extended to the new rows.
+    void parseDataSection(const char* begin, const char* end, DataSet& dataset, bool discoverLabels) {
+        const DataSet* declared = discoverLabels ? nullptr : &dataset;
+        bool hadRows = dataset.size() > 0;
+        size_t numFeatures = hadRows ? static_cast<size_t>(dataset.getNumFeatures()) : findRowLength(begin, end, declared);
+
+        std::vector<const char*> bounds = splitChunks(begin, end);
+        size_t numChunks = bounds.size() - 1;
+        std::vector<ParsedChunk> chunks(numChunks);
+        #pragma omp parallel for schedule(static, 1) if(numChunks > 1)
+        for (size_t c = 0; c < numChunks; ++c) {
+            parseChunk(bounds[c], bounds[c + 1], numFeatures, declared, chunks[c]);
+        }
+
+        size_t numRows = 0;
+        for (const auto& chunk : chunks) {
+            numRows += chunk.labels.size();
+        }
+
+        DataItem min = dataset.getMinFeatureValues();
+        DataItem max = dataset.getMaxFeatureValues();
+        if (!hadRows || min.features.size() != numFeatures || max.features.size() != numFeatures) {
+            min.features.assign(numFeatures, std::numeric_limits<float>::max());
+            max.features.assign(numFeatures, std::numeric_limits<float>::lowest());
+        }
+
+        bool reserved = false;
+        for (const auto& chunk : chunks) {
+            std::cerr << chunk.messages;
+
+            std::vector<ClassId> classMap;
+            for (const auto& classLabel : chunk.discovered) {
+                classMap.push_back(dataset.addClassLabel(classLabel));
+            }
+
+            for (size_t r = 0; r < chunk.labels.size(); ++r) {
+                ClassId classId = discoverLabels ? classMap[chunk.labels[r]] : chunk.labels[r];
+                dataset.addRow(chunk.features.data() + r * numFeatures, numFeatures, classId);
+                if (!reserved) {
+                    // The row length is known once the first row is in
+                    reserved = true;
+                    dataset.reserve(dataset.size() + numRows);
+                }
+            }
+
+            if (!chunk.labels.empty()) {
+                for (size_t k = 0; k < numFeatures; ++k) {
+                    min.features[k] = std::min(min.features[k], chunk.min[k]);
+                    max.features[k] = std::max(max.features[k], chunk.max[k]);
+                }
+            }
+        }
+
+        if (dataset.size() > 0) {
+            dataset.setMinFeatureValues(min);
+            dataset.setMaxFeatureValues(max);
+        }
+    }
+
+    // How the rows of a sparse data section are written.
+    struct SparseLayout {
+        bool libsvm; /**< Whether rows are "label index:value ...", else sparse ARFF "{index value, ...}". */
+        size_t classAttribute; /**< The index of the class attribute of a sparse ARFF row. */
+    };
+
+    // The rows of one chunk of a sparse data section, with the bounds of their stored values.
+    struct SparseChunk {
+        std::vector<uint32_t> indices; /**< The feature index of every stored value. */
+        std::vector<float> values; /**< The stored values. */
+        std::vector<size_t> offsets = {0}; /**< The first stored value of every row, plus the total. */
+        std::vector<ClassId> labels; /**< The declared ClassId, or the discovered label index, of every row. */
+        std::vector<std::string> discovered; /**< The labels discovered in the chunk, by local index. */
+        std::vector<float> min; /**< The minimum stored value of every feature. */
+        std::vector<float> max; /**< The maximum stored value of every feature. */
+        std::vector<size_t> stored; /**< The number of rows that store every feature. */
+        std::string messages; /**< The errors found, in line order. */
+    };
+
+    // Splits a sparse ARFF row into its non-zero features and its raw label, empty if omitted.
+    std::string_view splitSparseARFFRow(std::string_view line, size_t classAttribute,
+                                        std::vector<std::pair<uint32_t, float>>& entries, std::string& messages) {
+        size_t close = line.rfind('}');
+        std::string_view body = line.substr(1, close == std::string_view::npos ? std::string_view::npos : close - 1);
+        std::string_view rawLabel;
+        while (!body.empty()) {
+            size_t comma = body.find(',');
+            std::string_view entry = trim(body.substr(0, comma));
+            body = comma == std::string_view::npos ? std::string_view() : body.substr(comma + 1);
+            if (entry.empty()) {
+                continue;
+            }
+
+            size_t space = entry.find_first_of(" \t");
+            std::string_view value = space == std::string_view::npos ? std::string_view() : trim(entry.substr(space));
+            size_t attribute;
+            auto result = std::from_chars(entry.data(), entry.data() + entry.size(), attribute);
+            if (result.ec != std::errc() || space == std::string_view::npos) {
+                messages.append("Invalid sparse entry: ").append(entry).append("\n");
+            } else if (attribute == classAttribute) {
+                rawLabel = value;
+            } else {
+                float parsed;
+                if (parseFeature(value, parsed)) {
+                    entries.emplace_back(static_cast<uint32_t>(attribute > classAttribute ? attribute - 1 : attribute), parsed);
+                } else {
+                    messages.append("Invalid feature value: ").append(value).append("\n");
+                }
+            }
+        }
+        return rawLabel;
+    }
+
+    // Splits a libsvm row, with 1-based feature indices, into its non-zero features and its raw label.
+    std::string_view splitLibSVMRow(std::string_view line, std::vector<std::pair<uint32_t, float>>& entries,
+                                    std::string& messages) {
+        line = trim(line.substr(0, line.find('#')));
+        size_t space = line.find_first_of(" \t");
+        std::string_view rawLabel = line.substr(0, space);
+        std::string_view rest = space == std::string_view::npos ? std::string_view() : line.substr(space);
+        while (!rest.empty()) {
+            rest = trim(rest);
+            size_t next = rest.find_first_of(" \t");
+            std::string_view token = rest.substr(0, next);
+            rest = next == std::string_view::npos ? std::string_view() : rest.substr(next);
+            if (token.empty() || token.substr(0, 4) == "qid:") {
+                continue;
+            }
+
+            size_t colon = token.find(':');
+            size_t index = 0;
+            float value;
+            auto result = std::from_chars(token.data(), token.data() + token.size(), index);
+            if (colon == std::string_view::npos || result.ptr != token.data() + colon || index == 0 ||
+                !parseFeature(token.substr(colon + 1), value)) {
+                messages.append("Invalid sparse entry: ").append(token).append("\n");
+                continue;
+            }
+            entries.emplace_back(static_cast<uint32_t>(index - 1), value);
+        }
+        return rawLabel;
+    }
+
+    void parseSparseChunk(const char* cursor, const char* end, const SparseLayout& layout,
+                          const DataSet* declared, SparseChunk& chunk) {
+        LabelResolver labels(declared);
+        std::vector<std::pair<uint32_t, float>> entries;
+
+        while (cursor < end) {
+            std::string_view line = nextLine(cursor, end);
+            if (!isDataRow(line) || line[0] == '#') {
+                continue;
+            }
+
+            entries.clear();
+            std::string_view rawLabel = layout.libsvm ? splitLibSVMRow(line, entries, chunk.messages)
+                                                      : splitSparseARFFRow(line, layout.classAttribute, entries, chunk.messages);
+
+            // An omitted nominal value in sparse ARFF is the first declared one
+            ClassId classId = !layout.libsvm && rawLabel.empty() && declared->getNumClasses() > 0 ? 0 : labels.resolve(rawLabel);
+            if (classId == DataSet::NO_CLASS) {
+                chunk.messages.append("Error: Class label '").append(labels.describe(rawLabel))
+                              .append("' does not exist in the dataset's known classes.\n");
+                continue;
+            }
+
+            std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (size_t k = 0; k < entries.size(); ++k) {
+                auto [index, value] = entries[k];
+                if (value == 0.0f || (k + 1 < entries.size() && entries[k + 1].first == index)) {
+                    continue;
+                }
+                if (index >= chunk.min.size()) {
+                    chunk.min.resize(index + 1, std::numeric_limits<float>::max());
+                    chunk.max.resize(index + 1, std::numeric_limits<float>::lowest());
+                    chunk.stored.resize(index + 1, 0);
+                }
+                ++chunk.stored[index];
+                chunk.min[index] = std::min(chunk.min[index], value);
+                chunk.max[index] = std::max(chunk.max[index], value);
+                chunk.indices.push_back(index);
+                chunk.values.push_back(value);
+            }
+            chunk.offsets.push_back(chunk.values.size());
+            chunk.labels.push_back(classId);
+        }
+        chunk.discovered = labels.getDiscovered();
+    }
+
+    // Parses a sparse data section in parallel chunks like parseDataSection.
+    // The feature bounds also cover the implicit zeros of the rows that omit a feature.
+    void parseSparseSection(const char* begin, const char* end, DataSet& dataset, const SparseLayout& layout,
+                            size_t declaredFeatures) {
+        const DataSet* declared = layout.libsvm ? nullptr : &dataset;
+        bool hadRows = dataset.size() > 0;
+        dataset.makeSparse(declaredFeatures);
+        if (!dataset.isSparse()) {
+            return;
+        }
+
+        std::vector<const char*> bounds = splitChunks(begin, end);
+        size_t numChunks = bounds.size() - 1;
+        std::vector<SparseChunk> chunks(numChunks);
+        #pragma omp parallel for schedule(static, 1) if(numChunks > 1)
+        for (size_t c = 0; c < numChunks; ++c) {
+            parseSparseChunk(bounds[c], bounds[c + 1], layout, declared, chunks[c]);
+        }
+
+        size_t firstRow = dataset.size();
+        DataItem min = dataset.getMinFeatureValues();
+        DataItem max = dataset.getMaxFeatureValues();
+        if (!hadRows) {
+            min.features.clear();
+            max.features.clear();
+        }
+        std::vector<size_t> stored;
+        // Features new to a dataset that already has rows are zero in those rows
+        float padMin = hadRows ? 0.0f : std::numeric_limits<float>::max();
+        float padMax = hadRows ? 0.0f : std::numeric_limits<float>::lowest();
+
+        for (const auto& chunk : chunks) {
+            std::cerr << chunk.messages;
+
+            std::vector<ClassId> classMap;
+            for (const auto& classLabel : chunk.discovered) {
+                classMap.push_back(dataset.addClassLabel(classLabel));
+            }
+
+            for (size_t r = 0; r < chunk.labels.size(); ++r) {
+                ClassId classId = layout.libsvm ? classMap[chunk.labels[r]] : chunk.labels[r];
+                size_t first = chunk.offsets[r];
+                dataset.addSparseRow(chunk.indices.data() + first, chunk.values.data() + first,
+                                     chunk.offsets[r + 1] - first, classId);
+            }
+
+            if (chunk.min.size() > min.features.size()) {
+                min.features.resize(chunk.min.size(), padMin);
+                max.features.resize(chunk.max.size(), padMax);
+            }
+            stored.resize(std::max(stored.size(), chunk.stored.size()), 0);
+            for (size_t k = 0; k < chunk.min.size(); ++k) {
+                min.features[k] = std::min(min.features[k], chunk.min[k]);
+                max.features[k] = std::max(max.features[k], chunk.max[k]);
+                stored[k] += chunk.stored[k];
+            }
         }
 
-        while (getline(file, line)) {
-            std::string trimmedLine = toLowerCase(line);
-            trimmedLine.erase(0, trimmedLine.find_first_not_of(" \t"));
-            trimmedLine.erase(trimmedLine.find_last_not_of(" \t") + 1);
+        size_t numFeatures = dataset.getNumFeatures();
+        min.features.resize(numFeatures, padMin);
+        max.features.resize(numFeatures, padMax);
+        stored.resize(numFeatures, 0);
+        for (size_t k = 0; k < numFeatures && dataset.size() > firstRow; ++k) {
+            if (stored[k] < dataset.size() - firstRow) {
+                min.features[k] = std::min(min.features[k], 0.0f);
+                max.features[k] = std::max(max.features[k], 0.0f);
+            }
+        }
+        dataset.setMinFeatureValues(min);
+        dataset.setMaxFeatureValues(max);
+    }
+
+    bool endsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() &&
+               toLowerCase(text.substr(text.size() - suffix.size())) == suffix;
+    }
+
+    // What an ARFF reader has learned from the segments it has seen so far.
+    struct ARFFState {
+        bool inData = false; /**< Whether the @data line has been read. */
+        bool formatKnown = false; /**< Whether the first data row has been seen. */
+        bool sparse = false; /**< Whether the data rows are sparse. */
+        size_t numAttributes = 0; /**< The number of attributes declared, the class included. */
+        size_t classAttribute = 0; /**< The index of the class attribute. */
+    };
+
+    // Parses the next line-aligned segment of an ARFF file: header lines until @data, data rows after it.
+    void parseARFFSegment(const char* cursor, const char* end, DataSet& dataset, ARFFState& state) {
+        while (!state.inData && cursor < end) {
+            std::string_view line = nextLine(cursor, end);
+            bool hasKeyword = isKeyword(line);
+            bool isAttribute = hasKeyword && containsIgnoreCase(line, "@attribute");
+            state.numAttributes += isAttribute;
 
             // Extract class labels
-            if (trimmedLine.find("@attribute 'class'") != std::string::npos || 
-                trimmedLine.find("@attribute class") != std::string::npos || 
-                trimmedLine.find("@attribute 'target'") != std::string::npos) {
-                size_t braceOpen = trimmedLine.find('{');
-                size_t braceClose = trimmedLine.find('}', braceOpen);
-                if (braceOpen != std::string::npos && braceClose != std::string::npos) {
-                    std::string classesStr = trimmedLine.substr(braceOpen + 1, braceClose - braceOpen - 1);
-                    std::stringstream ss(classesStr);
+            if (hasKeyword && (containsIgnoreCase(line, "@attribute 'class'") ||
+                               containsIgnoreCase(line, "@attribute class") ||
+                               containsIgnoreCase(line, "@attribute 'target'"))) {
+                state.classAttribute = state.numAttributes - isAttribute;
+                size_t braceOpen = line.find('{');
+                size_t braceClose = line.find('}', braceOpen);
+                if (braceOpen != std::string_view::npos && braceClose != std::string_view::npos) {
+                    std::stringstream ss(toLowerCase(std::string(line.substr(braceOpen + 1, braceClose - braceOpen - 1))));
                     std::string classLabel;
                     while (getline(ss, classLabel, ',')) {
                         classLabel.erase(0, classLabel.find_first_not_of(" \t"));
@@ -61,90 +538,384 @@ namespace DataLoader {
                 continue;
             }
 
-            // Skip comments and empty lines
-            if (trimmedLine.empty() || trimmedLine[0] == '%') {
-                continue;
+            // Find data section
+            state.inData = hasKeyword && containsIgnoreCase(line, "@data");
+        }
+        if (!state.inData) {
+            return;
+        }
+
+        if (!state.formatKnown) {
+            // Sparse ARFF rows list "{index value, ...}" pairs instead of every value
+            const char* firstRow = cursor;
+            std::string_view row;
+            while (firstRow < end && !isDataRow(row = nextLine(firstRow, end))) {}
+            if (!isDataRow(row)) {
+                return;
             }
+            state.formatKnown = true;
+            state.sparse = row[0] == '{';
+        }
 
-            // Find data section
-            if (trimmedLine.find("@data") != std::string::npos) {
-                isDataSection = true;
-                continue;
+        if (state.sparse) {
+            size_t declaredFeatures = state.numAttributes > 0 ? state.numAttributes - 1 : 0;
+            parseSparseSection(cursor, end, dataset, SparseLayout{false, state.classAttribute}, declaredFeatures);
+        } else {
+            parseDataSection(cursor, end, dataset, false);
+        }
+    }
+
+    // Parses the next line-aligned segment of a CSV file, skipping a header in the first line.
+    void parseCSVSegment(const char* cursor, const char* end, DataSet& dataset, bool& headerChecked) {
+        if (!headerChecked) {
+            // Skip the header, recognized by a first value that is not a number
+            const char* firstRow = cursor;
+            std::string_view line;
+            while (cursor < end && (line = nextLine(cursor, end)).empty()) {
+                firstRow = cursor;
+            }
+            if (line.empty()) {
+                return;
             }
+            headerChecked = true;
+            float value;
+            if (!parseFeature(line.substr(0, line.find(',')), value)) {
+                firstRow = cursor;
+            }
+            cursor = firstRow;
+        }
 
-            if (isDataSection) {
-                std::stringstream ss(trimmedLine);
-                std::vector<float> features;
-                std::string value, rawClassLabel;
-                // Parse features
-                while (getline(ss, value, ',')) {
-                    if (ss.peek() == EOF) {
-                        // Last value is the class label
-                        rawClassLabel = value;
-                        // Normalize class label
-                        std::string classLabel = normalizeClassLabel(rawClassLabel);
-                        dataset.addItem(DataItem(features, classLabel));
-                        break;
-                    } else {
-                        try {
-                            features.push_back(std::stof(value));
-                        } catch (const std::invalid_argument& e) {
-                            std::cerr << "Invalid argument for stof: " << value << std::endl;
-                        }
-                    }
+        parseDataSection(cursor, end, dataset, true);
+    }
+
+    // Hands the text of a file to a segment parser: a mapped file in one segment, and a gzip
+    // file in line-aligned segments as they are decompressed by a background thread.
+    bool readText(const std::string& filename, DataSet& dataset,
+                  const std::function<void(const char*, const char*)>& parseSegment) {
+        MappedFile file(filename);
+        if (!file.isOpen()) {
+            std::cerr << "Unable to open file: " << filename << std::endl;
+            return false;
+        }
+        if (!GzipStream::isGzip(file.data(), file.size())) {
+            parseSegment(file.data(), file.data() + file.size());
+            return true;
+        }
+
+        GzipStream stream(filename);
+        if (!stream.isOpen()) {
+            std::cerr << "Unable to open file: " << filename << std::endl;
+            return false;
+        }
+
+        std::string pending, block;
+        size_t reservedRows = dataset.size();
+        auto parsePending = [&](size_t length) {
+            // Rows are reserved geometrically, since the parser only reserves the rows of one segment
+            size_t newRows = dataset.size() + std::count(pending.data(), pending.data() + length, '\n') + 1;
+            if (!dataset.isSparse() && newRows > reservedRows) {
+                reservedRows = std::max(newRows, 2 * reservedRows);
+                dataset.reserve(reservedRows);
+            }
+            parseSegment(pending.data(), pending.data() + length);
+            pending.erase(0, length);
+        };
+
+        while (stream.next(block)) {
+            pending.append(block);
+            size_t lastNewline = pending.rfind('\n');
+            if (lastNewline != std::string::npos) {
+                parsePending(lastNewline + 1);
+            }
+        }
+        if (!pending.empty()) {
+            parsePending(pending.size());
+        }
+
+        if (stream.hasFailed()) {
+            std::cerr << "Error: Compressed file is corrupt or truncated: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace DataLoader {
+    bool readARFF(const std::string& filename, DataSet& dataset) {
+        ARFFState state;
+        return readText(filename, dataset, [&](const char* begin, const char* end) {
+            parseARFFSegment(begin, end, dataset, state);
+        });
+    }
+
+    bool readCSV(const std::string& filename, DataSet& dataset) {
+        bool headerChecked = false;
+        return readText(filename, dataset, [&](const char* begin, const char* end) {
+            parseCSVSegment(begin, end, dataset, headerChecked);
+        });
+    }
+
+    bool readLibSVM(const std::string& filename, DataSet& dataset) {
+        return readText(filename, dataset, [&](const char* begin, const char* end) {
+            parseSparseSection(begin, end, dataset, SparseLayout{true, 0}, 0);
+        });
+    }
+
+    bool readFile(const std::string& filename, DataSet& dataset) {
+        // The format is given by the name without the compression suffix
+        std::string name = endsWith(filename, ".gz") ? filename.substr(0, filename.size() - 3) : filename;
+        if (endsWith(name, ".csv")) {
+            return readCSV(filename, dataset);
+        }
+        if (endsWith(name, ".libsvm") || endsWith(name, ".svm")) {
+            return readLibSVM(filename, dataset);
+        }
+        return readARFF(filename, dataset);
+    }
+
+    bool readNumpy(const NpyArray& features, const NpyArray& labels, DataSet& dataset, const std::vector<size_t>& rowOrder) {
+        const std::vector<size_t>& shape = features.getShape();
+        if (shape.size() != 2 || features.getKind() != 'f') {
+            std::cerr << "Error: Features must be a two-dimensional float32 or float64 array." << std::endl;
+            return false;
+        }
+        size_t numRows = shape[0];
+        size_t numFeatures = shape[1];
+        if (labels.getShape().size() != 1 || labels.getShape()[0] != numRows) {
+            std::cerr << "Error: Labels must be a one-dimensional array with one label per row." << std::endl;
+            return false;
+        }
+        if (dataset.size() > 0 && static_cast<size_t>(dataset.getNumFeatures()) != numFeatures) {
+            std::cerr << "Error: Features have " << numFeatures << " columns, expected " << dataset.getNumFeatures() << "." << std::endl;
+            return false;
+        }
+
+        DataItem min = dataset.getMinFeatureValues();
+        DataItem max = dataset.getMaxFeatureValues();
+        if (dataset.size() == 0 || min.features.size() != numFeatures || max.features.size() != numFeatures) {
+            min.features.assign(numFeatures, std::numeric_limits<float>::max());
+            max.features.assign(numFeatures, std::numeric_limits<float>::lowest());
+        }
+
+        // float32 rows in C order are copied straight out of the mapping, others converted value by value
+        bool direct = features.getItemSize() == sizeof(float) && !features.isFortranOrder();
+        LabelResolver resolver(nullptr);
+        std::vector<ClassId> classMap;
+        std::vector<float> row(numFeatures);
+        size_t numSelected = rowOrder.empty() ? numRows : rowOrder.size();
+        dataset.reserve(dataset.size() + numSelected);
+
+        for (size_t k = 0; k < numSelected; ++k) {
+            size_t r = rowOrder.empty() ? k : rowOrder[k];
+            if (r >= numRows) {
+                std::cerr << "Error: Row " << r << " is out of range." << std::endl;
+                continue;
+            }
+            if (direct) {
+                std::memcpy(row.data(), features.data() + r * numFeatures * sizeof(float), numFeatures * sizeof(float));
+            } else {
+                for (size_t i = 0; i < numFeatures; ++i) {
+                    row[i] = static_cast<float>(features.valueAt(r, i));
                 }
             }
+            if (!std::all_of(row.begin(), row.end(), [](float value) { return std::isfinite(value); })) {
+                std::cerr << "Error: Row " << r << " has a missing or infinite feature value." << std::endl;
+                continue;
+            }
+
+            ClassId localId = resolver.resolve(labels.textAt(r));
+            while (classMap.size() < resolver.getDiscovered().size()) {
+                classMap.push_back(dataset.addClassLabel(resolver.getDiscovered()[classMap.size()]));
+            }
+            dataset.addRow(row.data(), numFeatures, classMap[localId]);
+
+            for (size_t i = 0; i < numFeatures; ++i) {
+                min.features[i] = std::min(min.features[i], row[i]);
+                max.features[i] = std::max(max.features[i], row[i]);
+            }
         }
 
-        file.close();
+        if (dataset.size() > 0) {
+            dataset.setMinFeatureValues(min);
+            dataset.setMaxFeatureValues(max);
+        }
         return true;
     }
 
-    DataItem findMaxFeatureValues(const DataSet& dataset) {
-        DataItem maxFeatureValue;
+    // Finds the bounds of a sparse dataset, whose implicit zeros count as values too.
+    void findSparseBounds(const DataSet& dataset, DataItem& minFeatureValue, DataItem& maxFeatureValue) {
+        std::vector<size_t> stored(dataset.getNumFeatures(), 0);
+        minFeatureValue.features.assign(stored.size(), std::numeric_limits<float>::max());
+        maxFeatureValue.features.assign(stored.size(), std::numeric_limits<float>::lowest());
+        for (size_t r = 0; r < dataset.size(); ++r) {
+            SparseRow row = dataset.sparseRow(r);
+            for (size_t k = 0; k < row.size(); ++k) {
+                uint32_t feature = row.indices[k];
+                minFeatureValue.features[feature] = std::min(minFeatureValue.features[feature], row.values[k]);
+                maxFeatureValue.features[feature] = std::max(maxFeatureValue.features[feature], row.values[k]);
+                ++stored[feature];
+            }
+        }
+        for (size_t i = 0; i < stored.size(); ++i) {
+            if (stored[i] < dataset.size()) {
+                minFeatureValue.features[i] = std::min(minFeatureValue.features[i], 0.0f);
+                maxFeatureValue.features[i] = std::max(maxFeatureValue.features[i], 0.0f);
+            }
+        }
+    }
+
+    void findFeatureBounds(const DataSet& dataset, DataItem& minFeatureValue, DataItem& maxFeatureValue) {
+        minFeatureValue.features.clear();
+        maxFeatureValue.features.clear();
         if (dataset.size() == 0) {
-            return maxFeatureValue;
+            return;
+        }
+        if (dataset.isSparse()) {
+            findSparseBounds(dataset, minFeatureValue, maxFeatureValue);
+            return;
         }
 
-        maxFeatureValue.features = dataset.items[0].features;
-        for (const auto& item : dataset.items) {
-            for (size_t i = 0; i < item.features.size(); ++i) {
-                if (item.features[i] > maxFeatureValue.features[i]) {
-                    maxFeatureValue.features[i] = item.features[i];
-                }
+        // Both bounds in one pass over the rows
+        DataRow first = dataset.row(0);
+        minFeatureValue.features.assign(first.begin(), first.end());
+        maxFeatureValue.features.assign(first.begin(), first.end());
+        float* min = minFeatureValue.features.data();
+        float* max = maxFeatureValue.features.data();
+        for (size_t r = 1; r < dataset.size(); ++r) {
+            DataRow row = dataset.row(r);
+            for (size_t i = 0; i < row.size(); ++i) {
+                min[i] = std::min(min[i], row[i]);
+                max[i] = std::max(max[i], row[i]);
             }
         }
+    }
 
+    DataItem findMaxFeatureValues(const DataSet& dataset) {
+        DataItem minFeatureValue, maxFeatureValue;
+        findFeatureBounds(dataset, minFeatureValue, maxFeatureValue);
         return maxFeatureValue;
     }
 
     DataItem findMinFeatureValues(const DataSet& dataset) {
-        DataItem minFeatureValue;
+        DataItem minFeatureValue, maxFeatureValue;
+        findFeatureBounds(dataset, minFeatureValue, maxFeatureValue);
+        return minFeatureValue;
+    }
+
+    std::vector<bool> findConstantFeatures(const DataSet& dataset) {
+        std::vector<bool> constant(dataset.getNumFeatures(), true);
         if (dataset.size() == 0) {
-            return minFeatureValue;
+            return constant;
+        }
+        if (dataset.isSparse()) {
+            // A feature stored in fewer rows than the dataset has is also zero somewhere
+            std::vector<size_t> stored(constant.size(), 0);
+            std::vector<float> firstValue(constant.size(), 0.0f);
+            for (size_t r = 0; r < dataset.size(); ++r) {
+                SparseRow row = dataset.sparseRow(r);
+                for (size_t k = 0; k < row.size(); ++k) {
+                    uint32_t feature = row.indices[k];
+                    if (stored[feature]++ == 0) {
+                        firstValue[feature] = row.values[k];
+                    } else if (row.values[k] != firstValue[feature]) {
+                        constant[feature] = false;
+                    }
+                }
+            }
+            for (size_t i = 0; i < constant.size(); ++i) {
+                constant[i] = constant[i] && (stored[i] == 0 || stored[i] == dataset.size());
+            }
+            return constant;
         }
 
-        minFeatureValue.features = dataset.items[0].features;
-        for (const auto& item : dataset.items) {
-            for (size_t i = 0; i < item.features.size(); ++i) {
-                if (item.features[i] < minFeatureValue.features[i]) {
-                    minFeatureValue.features[i] = item.features[i];
+        DataRow first = dataset.row(0);
+        for (size_t r = 1; r < dataset.size(); ++r) {
+            DataRow row = dataset.row(r);
+            for (size_t i = 0; i < row.size(); ++i) {
+                if (row[i] != first[i]) {
+                    constant[i] = false;
                 }
             }
         }
 
-        return minFeatureValue;
+        return constant;
     }
 
     void normalizeFeatures(DataSet& dataset, const DataItem& minFeatureValue, const DataItem& maxFeatureValue) {
-        for (auto& item : dataset.items) {
-            for (size_t i = 0; i < item.features.size(); ++i) {
-                if (minFeatureValue.features[i] != maxFeatureValue.features[i]) {
-                    item.features[i] = (item.features[i] - minFeatureValue.features[i]) / (maxFeatureValue.features[i] - minFeatureValue.features[i]);
-                } else {
-                    item.features[i] = 0.0;
+        size_t numFeatures = dataset.getNumFeatures();
+        if (dataset.isSparse()) {
+            // Only scaled, so zeros stay implicit; the shift by the minimum leaves distances unchanged
+            for (size_t r = 0; r < dataset.size(); ++r) {
+                SparseRow row = dataset.sparseRow(r);
+                float* values = dataset.sparseValueData() + (row.values - dataset.sparseValueData());
+                for (size_t k = 0; k < row.size(); ++k) {
+                    float range = maxFeatureValue.features[row.indices[k]] - minFeatureValue.features[row.indices[k]];
+                    values[k] = range != 0.0f ? values[k] / range : 0.0f;
                 }
             }
+            return;
+        }
+
+        // Every column of the padded row gets an offset, a divisor and a bit mask that clears constant features
+        // and the padding to zero, so the loop below has no branch and runs over whole rows in vector registers
+        size_t stride = dataset.getStride();
+        std::vector<float> offset(stride, 0.0f), divisor(stride, 1.0f);
+        std::vector<uint32_t> mask(stride, 0);
+        for (size_t i = 0; i < numFeatures; ++i) {
+            if (minFeatureValue.features[i] != maxFeatureValue.features[i]) {
+                offset[i] = minFeatureValue.features[i];
+                divisor[i] = maxFeatureValue.features[i] - minFeatureValue.features[i];
+                mask[i] = ~uint32_t(0);
+            }
+        }
+
+        const float* offsets = offset.data();
+        const float* divisors = divisor.data();
+        const uint32_t* masks = mask.data();
+        size_t numRows = dataset.size();
+        bool parallel = numRows * stride * sizeof(float) >= 2 * MIN_PARALLEL_CHUNK_BYTES;
+        #pragma omp parallel for schedule(static) if (parallel)
+        for (size_t r = 0; r < numRows; ++r) {
+            float* features = dataset.rowData(r);
+            for (size_t i = 0; i < stride; ++i) {
+                float scaled = (features[i] - offsets[i]) / divisors[i];
+                uint32_t bits;
+                std::memcpy(&bits, &scaled, sizeof(bits));
+                bits &= masks[i];
+                std::memcpy(features + i, &bits, sizeof(bits));
+            }
+        }
+    }
+
+    UniqueRows deduplicate(const DataSet& dataset) {
+        UniqueRows unique;
+        for (ClassId c = 0; c < dataset.getNumClasses(); ++c) {
+            unique.rows.addClassLabel(dataset.getClassName(c));
+        }
+        size_t numFeatures = dataset.getNumFeatures();
+
+        // Rows are keyed by the bytes of their features; rows with the same features but another class stay apart
+        std::unordered_map<std::string_view, std::vector<uint32_t>> byFeatures;
+        byFeatures.reserve(dataset.size());
+        for (size_t r = 0; r < dataset.size(); ++r) {
+            DataRow row = dataset.row(r);
+            ClassId classId = dataset.getClassId(r);
+            std::vector<uint32_t>& candidates =
+                byFeatures[std::string_view(reinterpret_cast<const char*>(row.features), numFeatures * sizeof(float))];
+            auto match = std::find_if(candidates.begin(), candidates.end(),
+                                      [&](uint32_t u) { return unique.rows.getClassId(u) == classId; });
+            if (match != candidates.end()) {
+                if (unique.counts[*match]++ == 1) {
+                    unique.secondOccurrences[*match] = r;
+                }
+                continue;
+            }
+            candidates.push_back(static_cast<uint32_t>(unique.rows.size()));
+            unique.rows.addRow(row.features, numFeatures, classId);
+            unique.counts.push_back(1);
+            unique.firstOccurrences.push_back(r);
+            unique.secondOccurrences.push_back(NO_ROW);
         }
+        return unique;
     }
 }
@@ -1,18 +1,134 @@
 #include "data/DataSet.hpp"
+#include <algorithm>
 #include <iostream>
 
-DataSet::DataSet() {
-    items = std::vector<DataItem>();
-    uniqueClasses = std::set<std::string>();
+size_t DataSet::strideFor(size_t numFeatures) {
+    // Rounds the number of features up to a whole number of aligned blocks
+    constexpr size_t floatsPerBlock = ROW_ALIGNMENT / sizeof(float);
+    return (numFeatures + floatsPerBlock - 1) / floatsPerBlock * floatsPerBlock;
+}
+
+DataSet::DataSet() : numFeatures(0), stride(0), rowBase(nullptr), labelBase(nullptr), numRows(0),
+                     gapRow(NO_GAP), gapSize(0), borrowed(false), sparse(false), rowOffsets(1, 0),
+                     offsetBase(nullptr), indexBase(nullptr), valueBase(nullptr) {
+    rebind();
     minFeatureValue = DataItem();
     maxFeatureValue = DataItem();
 }
 
-int DataSet::getNumFeatures() const {
-    if (items.empty()) {
-        return 0;
+DataSet::DataSet(const DataSet& other)
+    : minFeatureValue(other.minFeatureValue), maxFeatureValue(other.maxFeatureValue),
+      features(other.features), labels(other.labels), classNames(other.classNames), classIds(other.classIds),
+      numFeatures(other.numFeatures), stride(other.stride), rowBase(other.rowBase), labelBase(other.labelBase),
+      numRows(other.numRows), gapRow(other.gapRow), gapSize(other.gapSize), borrowed(other.borrowed),
+      sparse(other.sparse), rowOffsets(other.rowOffsets), sparseIndices(other.sparseIndices),
+      sparseValues(other.sparseValues), offsetBase(other.offsetBase), indexBase(other.indexBase),
+      valueBase(other.valueBase) {
+    rebind();
+}
+
+DataSet::DataSet(DataSet&& other) noexcept
+    : minFeatureValue(std::move(other.minFeatureValue)), maxFeatureValue(std::move(other.maxFeatureValue)),
+      features(std::move(other.features)), labels(std::move(other.labels)),
+      classNames(std::move(other.classNames)), classIds(std::move(other.classIds)),
+      numFeatures(other.numFeatures), stride(other.stride), rowBase(other.rowBase), labelBase(other.labelBase),
+      numRows(other.numRows), gapRow(other.gapRow), gapSize(other.gapSize), borrowed(other.borrowed),
+      sparse(other.sparse), rowOffsets(std::move(other.rowOffsets)), sparseIndices(std::move(other.sparseIndices)),
+      sparseValues(std::move(other.sparseValues)), offsetBase(other.offsetBase), indexBase(other.indexBase),
+      valueBase(other.valueBase) {
+    rebind();
+    other.clear();
+}
+
+DataSet& DataSet::operator=(const DataSet& other) {
+    if (this != &other) {
+        DataSet copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+DataSet& DataSet::operator=(DataSet&& other) noexcept {
+    if (this != &other) {
+        minFeatureValue = std::move(other.minFeatureValue);
+        maxFeatureValue = std::move(other.maxFeatureValue);
+        features = std::move(other.features);
+        labels = std::move(other.labels);
+        classNames = std::move(other.classNames);
+        classIds = std::move(other.classIds);
+        numFeatures = other.numFeatures;
+        stride = other.stride;
+        rowBase = other.rowBase;
+        labelBase = other.labelBase;
+        numRows = other.numRows;
+        gapRow = other.gapRow;
+        gapSize = other.gapSize;
+        borrowed = other.borrowed;
+        sparse = other.sparse;
+        rowOffsets = std::move(other.rowOffsets);
+        sparseIndices = std::move(other.sparseIndices);
+        sparseValues = std::move(other.sparseValues);
+        offsetBase = other.offsetBase;
+        indexBase = other.indexBase;
+        valueBase = other.valueBase;
+        rebind();
+        other.clear();
+    }
+    return *this;
+}
+
+void DataSet::rebind() {
+    if (!borrowed) {
+        rowBase = features.data();
+        labelBase = labels.data();
+        numRows = labels.size();
+        offsetBase = rowOffsets.data();
+        indexBase = sparseIndices.data();
+        valueBase = sparseValues.data();
+    }
+}
+
+DataSet DataSet::view(const DataSet& source, size_t firstRow, size_t count) {
+    DataSet result;
+    result.classNames = source.classNames;
+    result.classIds = source.classIds;
+    result.numFeatures = source.numFeatures;
+    result.stride = source.stride;
+    result.rowBase = source.rowBase + firstRow * source.stride;
+    result.labelBase = source.labelBase + firstRow;
+    result.numRows = count;
+    result.borrowed = true;
+    result.sparse = source.sparse;
+    result.offsetBase = source.offsetBase + firstRow;
+    result.indexBase = source.indexBase;
+    result.valueBase = source.valueBase;
+    return result;
+}
+
+DataSet DataSet::viewExcluding(const DataSet& source, size_t firstExcluded, size_t numExcluded) {
+    DataSet result = view(source, 0, source.size() - numExcluded);
+    result.gapRow = firstExcluded;
+    result.gapSize = numExcluded;
+    return result;
+}
+
+DataSet DataSet::wrap(const float* rows, const ClassId* labels, size_t numRows, size_t numFeatures,
+                      const std::vector<std::string>& classNames) {
+    DataSet result;
+    for (const auto& className : classNames) {
+        result.addClassLabel(className);
     }
-    return items[0].features.size();
+    result.numFeatures = numFeatures;
+    result.stride = strideFor(numFeatures);
+    result.rowBase = rows;
+    result.labelBase = labels;
+    result.numRows = numRows;
+    result.borrowed = true;
+    return result;
+}
+
+int DataSet::getNumFeatures() const {
+    return numFeatures;
 }
 
 void DataSet::setMaxFeatureValues(DataItem maxFeatureValue) {
@@ -32,40 +148,172 @@ DataItem DataSet::getMinFeatureValues() {
 }
 
 void DataSet::addItem(const DataItem& item) {
-    if (uniqueClasses.find(item.label) != uniqueClasses.end()) {
-        items.push_back(item);
-    } else {
+    ClassId classId = getClassId(item.label);
+    if (classId == NO_CLASS) {
         std::cerr << "Error: Class label '" << item.label << "' does not exist in the dataset's known classes." << std::endl;
+        return;
+    }
+    addRow(item.features.data(), item.features.size(), classId);
+}
+
+void DataSet::addRow(const float* rowFeatures, size_t rowSize, ClassId classId) {
+    if (borrowed) {
+        std::cerr << "Error: Rows cannot be added to a view of another dataset." << std::endl;
+        return;
+    }
+    if (sparse) {
+        std::cerr << "Error: Dense rows cannot be added to a sparse dataset." << std::endl;
+        return;
+    }
+    if (classId >= classNames.size()) {
+        std::cerr << "Error: Class identifier " << classId << " does not exist in the dataset's known classes." << std::endl;
+        return;
     }
+
+    if (labels.empty()) {
+        numFeatures = rowSize;
+        stride = strideFor(numFeatures);
+    } else if (rowSize != numFeatures) {
+        std::cerr << "Error: Data item has " << rowSize << " features, expected " << numFeatures << "." << std::endl;
+        return;
+    }
+
+    size_t offset = features.size();
+    features.resize(offset + stride, 0.0f);
+    std::copy(rowFeatures, rowFeatures + rowSize, features.begin() + offset);
+    labels.push_back(classId);
+    rebind();
+}
+
+void DataSet::makeSparse(size_t declaredFeatures) {
+    if (size() > 0 && !sparse) {
+        std::cerr << "Error: A dataset with dense rows cannot become sparse." << std::endl;
+        return;
+    }
+    sparse = true;
+    numFeatures = std::max(numFeatures, declaredFeatures);
+    stride = 0;
+}
+
+void DataSet::addSparseRow(const uint32_t* indices, const float* values, size_t count, ClassId classId) {
+    if (borrowed || !sparse) {
+        std::cerr << "Error: Sparse rows can only be added to a sparse dataset that owns its rows." << std::endl;
+        return;
+    }
+    if (classId >= classNames.size()) {
+        std::cerr << "Error: Class identifier " << classId << " does not exist in the dataset's known classes." << std::endl;
+        return;
+    }
+    for (size_t k = 1; k < count; ++k) {
+        if (indices[k] <= indices[k - 1]) {
+            std::cerr << "Error: Sparse row has feature " << indices[k] << " after feature " << indices[k - 1] << "." << std::endl;
+            return;
+        }
+    }
+
+    if (count > 0) {
+        numFeatures = std::max<size_t>(numFeatures, indices[count - 1] + size_t(1));
+    }
+    sparseIndices.insert(sparseIndices.end(), indices, indices + count);
+    sparseValues.insert(sparseValues.end(), values, values + count);
+    rowOffsets.push_back(sparseValues.size());
+    labels.push_back(classId);
+    rebind();
+}
+
+void DataSet::reserve(size_t count) {
+    labels.reserve(count);
+    if (stride > 0) {
+        features.reserve(count * stride);
+    }
+    rebind();
 }
 
 void DataSet::addDataSet(const DataSet& dataset) {
-    for (const auto& item : dataset.items) {
-        addItem(item);
+    reserve(size() + dataset.size());
+    std::vector<ClassId> classMap = dataset.mapClassIds(*this);
+    for (size_t i = 0; i < dataset.size(); ++i) {
+        ClassId classId = classMap[dataset.getClassId(i)];
+        if (classId == NO_CLASS) {
+            std::cerr << "Error: Class label '" << dataset.getLabel(i) << "' does not exist in the dataset's known classes." << std::endl;
+            continue;
+        }
+        if (dataset.isSparse()) {
+            makeSparse(dataset.numFeatures);
+            SparseRow row = dataset.sparseRow(i);
+            addSparseRow(row.indices, row.values, row.size(), classId);
+            continue;
+        }
+        DataRow row = dataset.row(i);
+        addRow(row.features, row.size(), classId);
     }
 }
 
 size_t DataSet::size() const {
-    return items.size();
+    return numRows;
 }
 
-void DataSet::addClassLabel(const std::string& classLabel) {
-    uniqueClasses.insert(classLabel);
+ClassId DataSet::addClassLabel(const std::string& classLabel) {
+    auto it = classIds.find(classLabel);
+    if (it != classIds.end()) {
+        return it->second;
+    }
+    if (classNames.size() >= NO_CLASS) {
+        std::cerr << "Error: Too many classes, class label '" << classLabel << "' ignored." << std::endl;
+        return NO_CLASS;
+    }
+
+    ClassId classId = static_cast<ClassId>(classNames.size());
+    classNames.push_back(classLabel);
+    classIds.emplace(classLabel, classId);
+    return classId;
 }
 
 bool DataSet::classLabelExists(const std::string& classLabel) const {
-    return uniqueClasses.find(classLabel) != uniqueClasses.end();
+    return classIds.find(classLabel) != classIds.end();
 }
 
-void DataSet::clear() {
-    items.clear();
-    uniqueClasses.clear();
+ClassId DataSet::getClassId(const std::string& classLabel) const {
+    auto it = classIds.find(classLabel);
+    return it != classIds.end() ? it->second : NO_CLASS;
+}
+
+const std::string& DataSet::getClassName(ClassId classId) const {
+    return classNames[classId];
 }
 
-DataItem& DataSet::operator[](int index) {
-    return items[index];
+std::vector<ClassId> DataSet::mapClassIds(const DataSet& reference) const {
+    std::vector<ClassId> classMap(classNames.size());
+    for (size_t c = 0; c < classNames.size(); ++c) {
+        classMap[c] = reference.getClassId(classNames[c]);
+    }
+    return classMap;
 }
 
-const DataItem& DataSet::operator[](int index) const {
-    return items[index];
+bool DataSet::sharesRowsWith(const DataSet& other) const {
+    if (size() != other.size() || numFeatures != other.numFeatures || sparse != other.sparse ||
+        labelBase != other.labelBase || gapRow != other.gapRow || gapSize != other.gapSize) {
+        return false;
+    }
+    if (sparse) {
+        return offsetBase == other.offsetBase && indexBase == other.indexBase && valueBase == other.valueBase;
+    }
+    return rowBase == other.rowBase && stride == other.stride;
+}
+
+void DataSet::clear() {
+    features.clear();
+    labels.clear();
+    classNames.clear();
+    classIds.clear();
+    numFeatures = 0;
+    stride = 0;
+    gapRow = NO_GAP;
+    gapSize = 0;
+    borrowed = false;
+    sparse = false;
+    rowOffsets.assign(1, 0);
+    sparseIndices.clear();
+    sparseValues.clear();
+    rebind();
 }
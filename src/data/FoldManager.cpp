@@ -0,0 +1,331 @@
+#include "data/FoldManager.hpp"
+#include "data/DataLoader.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <unistd.h>
+
+namespace {
+    constexpr char CACHE_MAGIC[8] = {'F', 'W', 'C', 'A', 'C', 'H', 'E', '\0'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // Mixes a block of bytes into a 64-bit FNV-1a style hash, eight bytes at a time.
+    uint64_t hashBytes(uint64_t hash, const char* bytes, size_t length) {
+        constexpr uint64_t prime = 1099511628211ULL;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (; i < length; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(bytes[i])) * prime;
+        }
+        return hash;
+    }
+
+    uint64_t alignUp(uint64_t offset, uint64_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    bool endsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    // Checks that a section of count elements of the given size lies inside the file.
+    bool fits(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize) {
+        return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+    }
+}
+
+size_t FoldManager::partitionStart(size_t partition) const {
+    return std::accumulate(partitionSizes.begin(), partitionSizes.begin() + partition, size_t(0));
+}
+
+bool FoldManager::isNumpySource(const std::vector<std::string>& filenames) {
+    return filenames.size() == 1 && (endsWith(filenames[0], ".npz") || endsWith(filenames[0], NUMPY_FEATURES_SUFFIX));
+}
+
+std::vector<std::string> FoldManager::sourceFiles(const std::vector<std::string>& filenames) {
+    if (!isNumpySource(filenames) || endsWith(filenames[0], ".npz")) {
+        return filenames;
+    }
+    std::string prefix = filenames[0].substr(0, filenames[0].size() - std::strlen(NUMPY_FEATURES_SUFFIX));
+    return {filenames[0], prefix + NUMPY_LABELS_SUFFIX, prefix + NUMPY_FOLDS_SUFFIX};
+}
+
+uint64_t FoldManager::hashFiles(const std::vector<std::string>& filenames) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto& filename : sourceFiles(filenames)) {
+        MappedFile file(filename);
+        uint64_t length = file.isOpen() ? file.size() : ~uint64_t(0);
+        hash = hashBytes(hash, reinterpret_cast<const char*>(&length), sizeof(length));
+        if (file.isOpen()) {
+            hash = hashBytes(hash, file.data(), file.size());
+        }
+    }
+    return hash;
+}
+
+bool FoldManager::parse(const std::vector<std::string>& filenames) {
+    cache.reset();
+    storage.clear();
+    partitionSizes.clear();
+    if (isNumpySource(filenames)) {
+        return parseNumpy(filenames[0]);
+    }
+
+    bool loaded = true;
+    for (const auto& filename : filenames) {
+        size_t before = storage.size();
+        loaded = DataLoader::readFile(filename, storage) && loaded;
+        partitionSizes.push_back(storage.size() - before);
+    }
+    normalize();
+    return loaded;
+}
+
+bool FoldManager::parseNumpy(const std::string& source) {
+    bool archive = endsWith(source, ".npz");
+    std::vector<std::string> files = sourceFiles({source});
+    NpyArray features(source, archive ? "features" : "");
+    NpyArray labels(archive ? source : files[1], archive ? "labels" : "");
+    NpyArray folds(archive ? source : files[2], archive ? "folds" : "");
+    for (const NpyArray* array : {&features, &labels, &folds}) {
+        if (!array->isOpen()) {
+            std::cerr << "Error: " << array->getError() << std::endl;
+            return false;
+        }
+    }
+
+    size_t numRows = features.getShape().empty() ? 0 : features.getShape()[0];
+    if (folds.getShape().size() != 1 || folds.getShape()[0] != numRows ||
+        (folds.getKind() != 'i' && folds.getKind() != 'u')) {
+        std::cerr << "Error: Folds must be a one-dimensional integer array with one fold per row." << std::endl;
+        return false;
+    }
+
+    // Every distinct fold value is a partition, in increasing order, with its rows in array order
+    std::vector<std::pair<double, size_t>> rowsByFold(numRows);
+    for (size_t r = 0; r < numRows; ++r) {
+        rowsByFold[r] = {folds.valueAt(r), r};
+    }
+    std::stable_sort(rowsByFold.begin(), rowsByFold.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    bool loaded = true;
+    for (size_t first = 0; first < numRows;) {
+        std::vector<size_t> rowOrder;
+        size_t last = first;
+        for (; last < numRows && rowsByFold[last].first == rowsByFold[first].first; ++last) {
+            rowOrder.push_back(rowsByFold[last].second);
+        }
+        size_t before = storage.size();
+        loaded = DataLoader::readNumpy(features, labels, storage, rowOrder) && loaded;
+        partitionSizes.push_back(storage.size() - before);
+        first = last;
+    }
+    normalize();
+    return loaded;
+}
+
+void FoldManager::normalize() {
+    DataItem min = storage.getMinFeatureValues();
+    DataItem max = storage.getMaxFeatureValues();
+    size_t numFeatures = storage.getNumFeatures();
+    if (min.features.size() != numFeatures || max.features.size() != numFeatures) {
+        DataLoader::findFeatureBounds(storage, min, max);
+    }
+    DataLoader::normalizeFeatures(storage, min, max);
+    storage.setMinFeatureValues(min);
+    storage.setMaxFeatureValues(max);
+}
+
+bool FoldManager::load(const std::vector<std::string>& filenames, const std::string& cachePath) {
+    if (cachePath.empty()) {
+        return parse(filenames);
+    }
+
+    uint64_t contentHash = hashFiles(filenames);
+    if (readCache(cachePath, contentHash) && (isNumpySource(filenames) || partitionSizes.size() == filenames.size())) {
+        return true;
+    }
+
+    if (!parse(filenames)) {
+        return false;
+    }
+    if (!storage.isSparse() && !writeCache(cachePath, contentHash)) {
+        std::cerr << "Warning: Unable to write dataset cache: " << cachePath << std::endl;
+    }
+    return true;
+}
+
+bool FoldManager::convert(const std::vector<std::string>& filenames, const std::string& cachePath) {
+    return parse(filenames) && writeCache(cachePath, hashFiles(filenames));
+}
+
+bool FoldManager::readCache(const std::string& cachePath, uint64_t contentHash) {
+    auto file = std::make_unique<MappedFile>(cachePath);
+    if (!file->isOpen() || file->size() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    uint64_t fileSize = file->size();
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.contentHash != contentHash || header.fileSize != fileSize) {
+        return false;
+    }
+
+    // No count can exceed the file size, which keeps the sizes computed from them below from overflowing
+    if (header.numFeatures == 0 || header.numFeatures > fileSize || header.numPartitions >= fileSize) {
+        return false;
+    }
+
+    uint64_t stride = DataSet::strideFor(header.numFeatures);
+    if (header.featuresOffset % DataSet::ROW_ALIGNMENT != 0 ||
+        !fits(header.partitionsOffset, header.numPartitions + 1, sizeof(uint64_t), fileSize) ||
+        !fits(header.boundsOffset, 2 * header.numFeatures, sizeof(float), fileSize) ||
+        !fits(header.featuresOffset, header.numRows, stride * sizeof(float), fileSize) ||
+        !fits(header.labelsOffset, header.numRows, sizeof(ClassId), fileSize) ||
+        header.classesOffset > fileSize) {
+        return false;
+    }
+
+    const char* data = file->data();
+    std::vector<uint64_t> partitionStarts(header.numPartitions + 1);
+    std::memcpy(partitionStarts.data(), data + header.partitionsOffset, partitionStarts.size() * sizeof(uint64_t));
+    if (partitionStarts.front() != 0 || partitionStarts.back() != header.numRows) {
+        return false;
+    }
+    std::vector<size_t> sizes;
+    for (size_t p = 0; p < header.numPartitions; ++p) {
+        if (partitionStarts[p + 1] < partitionStarts[p]) {
+            return false;
+        }
+        sizes.push_back(partitionStarts[p + 1] - partitionStarts[p]);
+    }
+
+    std::vector<std::string> classNames;
+    uint64_t offset = header.classesOffset;
+    for (uint64_t c = 0; c < header.numClasses; ++c) {
+        uint32_t length;
+        if (!fits(offset, 1, sizeof(length), fileSize)) {
+            return false;
+        }
+        std::memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(length);
+        if (!fits(offset, length, 1, fileSize)) {
+            return false;
+        }
+        classNames.emplace_back(data + offset, length);
+        offset += length;
+    }
+
+    const ClassId* labels = reinterpret_cast<const ClassId*>(data + header.labelsOffset);
+    for (uint64_t i = 0; i < header.numRows; ++i) {
+        if (labels[i] >= header.numClasses) {
+            return false;
+        }
+    }
+
+    DataItem min, max;
+    const float* bounds = reinterpret_cast<const float*>(data + header.boundsOffset);
+    min.features.assign(bounds, bounds + header.numFeatures);
+    max.features.assign(bounds + header.numFeatures, bounds + 2 * header.numFeatures);
+
+    storage = DataSet::wrap(reinterpret_cast<const float*>(data + header.featuresOffset), labels,
+                            header.numRows, header.numFeatures, classNames);
+    storage.setMinFeatureValues(min);
+    storage.setMaxFeatureValues(max);
+    partitionSizes = std::move(sizes);
+    cache = std::move(file);
+    return true;
+}
+
+bool FoldManager::writeCache(const std::string& cachePath, uint64_t contentHash) const {
+    if (storage.isSparse()) {
+        std::cerr << "Error: Sparse datasets have no dataset cache." << std::endl;
+        return false;
+    }
+
+    size_t numRows = storage.size();
+    size_t numFeatures = storage.getNumFeatures();
+    size_t stride = storage.getStride();
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.contentHash = contentHash;
+    header.numRows = numRows;
+    header.numFeatures = numFeatures;
+    header.numPartitions = partitionSizes.size();
+    header.numClasses = storage.getNumClasses();
+
+    std::vector<uint64_t> partitionStarts(1, 0);
+    for (size_t partitionSize : partitionSizes) {
+        partitionStarts.push_back(partitionStarts.back() + partitionSize);
+    }
+
+    std::vector<float> bounds(storage.minFeatureValue.features);
+    bounds.insert(bounds.end(), storage.maxFeatureValue.features.begin(), storage.maxFeatureValue.features.end());
+    bounds.resize(2 * numFeatures, 0.0f);
+
+    std::string classes;
+    for (ClassId c = 0; c < storage.getNumClasses(); ++c) {
+        const std::string& className = storage.getClassName(c);
+        uint32_t length = static_cast<uint32_t>(className.size());
+        classes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        classes.append(className);
+    }
+
+    std::vector<ClassId> labels(numRows);
+    for (size_t i = 0; i < numRows; ++i) {
+        labels[i] = storage.getClassId(i);
+    }
+
+    header.partitionsOffset = sizeof(CacheHeader);
+    header.boundsOffset = header.partitionsOffset + partitionStarts.size() * sizeof(uint64_t);
+    header.classesOffset = header.boundsOffset + bounds.size() * sizeof(float);
+    header.featuresOffset = alignUp(header.classesOffset + classes.size(), DataSet::ROW_ALIGNMENT);
+    header.labelsOffset = header.featuresOffset + numRows * stride * sizeof(float);
+    header.fileSize = header.labelsOffset + numRows * sizeof(ClassId);
+
+    std::string temporaryPath = cachePath + ".tmp" + std::to_string(getpid());
+    std::ofstream out(temporaryPath, std::ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    std::vector<char> padding(header.featuresOffset - header.classesOffset - classes.size(), 0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(partitionStarts.data()), partitionStarts.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(bounds.data()), bounds.size() * sizeof(float));
+    out.write(classes.data(), classes.size());
+    out.write(padding.data(), padding.size());
+    if (numRows > 0) {
+        // Owned rows are contiguous, padding included
+        out.write(reinterpret_cast<const char*>(storage.row(0).features), numRows * stride * sizeof(float));
+    }
+    out.write(reinterpret_cast<const char*>(labels.data()), labels.size() * sizeof(ClassId));
+    out.close();
+
+    if (!out || std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+DataSet FoldManager::getTrainingSet(size_t fold) const {
+    return DataSet::viewExcluding(storage, partitionStart(fold), partitionSizes[fold]);
+}
+
+DataSet FoldManager::getTestSet(size_t fold) const {
+    return DataSet::view(storage, partitionStart(fold), partitionSizes[fold]);
+}
@@ -9,8 +9,10 @@
 #include "algorithms/AlgorithmFactory.hpp"
 #include "data/DataLoader.hpp"
 #include "data/DataSet.hpp"
+#include "data/FoldManager.hpp"
 #include "utils/Utils.hpp"
 #include "utils/RandomUtils.hpp"
+#include "utils/MathUtils.hpp"
 #include "Evaluation.hpp"
 
 void processFold(std::ofstream& csvFile, const std::string& datasetName,
@@ -19,9 +21,45 @@ void processFold(std::ofstream& csvFile, const std::string& datasetName,
                  const std::string& algorithmName, unsigned seed,
                  const std::string& resultsFilename, bool logResults);
 
+/**
+ * @brief Returns the data file of every partition of a dataset.
+ *
+ * A partition is read from its ARFF file, or from a libsvm file with the
+ * same name when there is no ARFF file. Either may be gzip-compressed, with
+ * a .gz suffix added to the name. A dataset stored as NumPy arrays, in
+ * DATASET_NAME.npz or DATASET_NAME_features.npy, takes precedence and holds
+ * every partition.
+ *
+ * @param datasetName The name of the dataset.
+ * @return The path of every partition, in fold order, or the single NumPy source.
+ */
+std::vector<std::string> getPartitionPaths(const std::string& datasetName);
+
+/**
+ * @brief Returns the path of the binary cache of a dataset.
+ *
+ * @param datasetName The name of the dataset.
+ * @return The path of the cache file.
+ */
+std::string getCachePath(const std::string& datasetName);
+
+/**
+ * @brief Builds the binary cache of a dataset.
+ *
+ * @param argc The number of arguments, the first one being the subcommand.
+ * @param argv The arguments.
+ * @return The exit code of the program.
+ */
+int convertDataset(int argc, char* argv[]);
+
 int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "convert") {
+        return convertDataset(argc, argv);
+    }
+
     if (argc < 3) {
         std::cerr << "Usage: " << argv[0] << " --algorithm=ALGORITHM_NAME --dataset=DATASET_NAME [--param1=value1 ...]" << std::endl;
+        std::cerr << "       " << argv[0] << " convert --dataset=DATASET_NAME" << std::endl;
         return 1;
     }
 
@@ -81,9 +119,13 @@ int main(int argc, char* argv[]) {
         parameters["seed"] = randomSeed;
     }  
 
+    // Kernel selection may warn about FWL_DISTANCE_KERNEL, so it happens before the header is printed
+    const char* kernelName = MathUtils::getDistanceKernelName();
+
     std::cout << "\n--------------------------------------------------" << std::endl;
     std::cout << "ALGORITHM: " << algorithmName << std::endl;
     std::cout << "DATASET: " << datasetName << std::endl;
+    std::cout << "DISTANCE KERNEL: " << kernelName << std::endl;
     std::cout << "HYPERPARAMETERS:" << std::endl;
     for (const auto& param : parameters) {
         std::cout << param.first << ": " << param.second << std::endl;
@@ -101,31 +143,23 @@ int main(int argc, char* argv[]) {
         csvFile.close();
     }
     
-    std::vector<std::string> dataFiles = {"1.arff", "2.arff", "3.arff", "4.arff", "5.arff"};
-
-    for (size_t testIndex = 0; testIndex < dataFiles.size(); ++testIndex) {
-        DataSet train, test;
-        DataLoader::readARFF("./data/" + datasetName + "_" + dataFiles[testIndex], test);
-        for (size_t i = 0; i < dataFiles.size(); ++i) {
-            if (i != testIndex) {
-                DataLoader::readARFF("./data/" + datasetName + "_" + dataFiles[i], train);
-            }
-        }
+    FoldManager folds;
+    if (!folds.load(getPartitionPaths(datasetName), getCachePath(datasetName)) || folds.getNumFolds() == 0) {
+        std::cerr << "Unable to load dataset: " << datasetName << std::endl;
+        return 1;
+    }
 
-        DataItem max = DataLoader::findMaxFeatureValues(train);
-        DataItem min = DataLoader::findMinFeatureValues(train);
-        DataItem maxTest = DataLoader::findMaxFeatureValues(test);
-        DataItem minTest = DataLoader::findMinFeatureValues(test);
+    for (size_t testIndex = 0; testIndex < folds.getNumFolds(); ++testIndex) {
+        DataSet train = folds.getTrainingSet(testIndex);
+        DataSet test = folds.getTestSet(testIndex);
 
-        for (size_t i = 0; i < max.features.size(); ++i) {
-            max.features.at(i) = std::max(max.features.at(i), maxTest.features.at(i));
-            min.features.at(i) = std::min(min.features.at(i), minTest.features.at(i));
+        size_t fitnessCacheCapacity = parameters.find("fitnessCacheSize") != parameters.end() ? static_cast<size_t>(parameters["fitnessCacheSize"] * (1 << 20)) : Evaluation::DEFAULT_FITNESS_CACHE_CAPACITY;
+        size_t memoryBudget = parameters.find("memoryBudget") != parameters.end() ? static_cast<size_t>(parameters["memoryBudget"] * (1 << 20)) : Evaluation::DEFAULT_MEMORY_BUDGET;
+        bool deduplicate = parameters.find("deduplicate") != parameters.end() && parameters["deduplicate"] != 0.0f;
+        std::shared_ptr<Evaluation> eval = std::make_shared<Evaluation>(train, parameters["alpha"], parameters["reductionThreshold"], fitnessCacheCapacity, memoryBudget, deduplicate);
+        if (parameters.find("solutionThreads") != parameters.end()) {
+            eval->setSolutionThreads(static_cast<size_t>(parameters["solutionThreads"]));
         }
-
-        DataLoader::normalizeFeatures(train, min, max);
-        DataLoader::normalizeFeatures(test, min, max);
-
-        std::shared_ptr<Evaluation> eval = std::make_shared<Evaluation>(train, parameters["alpha"], parameters["reductionThreshold"]);
         auto algorithm = AlgorithmFactory::createAlgorithm(algorithmName, parameters, eval);
         if (!algorithm) {
             std::cerr << "Unknown algorithm: " << algorithmName << std::endl;
@@ -141,6 +175,59 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
+std::vector<std::string> getPartitionPaths(const std::string& datasetName) {
+    for (const std::string& numpyPath : {"./data/" + datasetName + ".npz",
+                                         "./data/" + datasetName + FoldManager::NUMPY_FEATURES_SUFFIX}) {
+        if (std::ifstream(numpyPath).good()) {
+            return {numpyPath};
+        }
+    }
+
+    std::vector<std::string> dataFiles = {"1", "2", "3", "4", "5"};
+    std::vector<std::string> dataPaths;
+    for (const auto& dataFile : dataFiles) {
+        std::string basePath = "./data/" + datasetName + "_" + dataFile;
+        std::string dataPath = basePath + ".arff";
+        for (const char* extension : {".arff", ".arff.gz", ".libsvm", ".libsvm.gz"}) {
+            if (std::ifstream(basePath + extension).good()) {
+                dataPath = basePath + extension;
+                break;
+            }
+        }
+        dataPaths.push_back(dataPath);
+    }
+    return dataPaths;
+}
+
+std::string getCachePath(const std::string& datasetName) {
+    return "./data/" + datasetName + ".fwcache";
+}
+
+int convertDataset(int argc, char* argv[]) {
+    std::string datasetName;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--dataset=", 0) == 0) {
+            datasetName = arg.substr(std::string("--dataset=").size());
+        }
+    }
+
+    if (datasetName.empty()) {
+        std::cerr << "Missing required argument --dataset." << std::endl;
+        return 1;
+    }
+
+    FoldManager folds;
+    std::string cachePath = getCachePath(datasetName);
+    if (!folds.convert(getPartitionPaths(datasetName), cachePath)) {
+        std::cerr << "Unable to build dataset cache: " << cachePath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Dataset cache written: " << cachePath << std::endl;
+    return 0;
+}
+
 void processFold(std::ofstream& csvFile, const std::string& datasetName,
                  size_t fold, const DataSet& train, const DataSet& test,
                  std::shared_ptr<Evaluation> eval, std::unique_ptr<Algorithm> algorithm, 
@@ -162,6 +249,8 @@ void processFold(std::ofstream& csvFile, const std::string& datasetName,
     std::cout << "Training fitness value: " << solution.fitness << std::endl;
     std::cout << "Test fitness value: " << fitness << std::endl;
     std::cout << "Execution time: " << duration.count() << "s" << std::endl;
+    std::cout << "Fitness cache: " << eval->getFitnessCache().getHits() << " hits, "
+              << eval->getFitnessCache().getMisses() << " misses" << std::endl;
 
     if (logResults) {
         std::string solutionID = Utils::saveSolutionToJSON(solution.solution.weights);
@@ -0,0 +1,435 @@
+#include "utils/MathUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FWL_X86_KERNELS 1
+#endif
+
+namespace {
+    /**
+     * @brief Table of distance kernels for one instruction set.
+     *
+     * Every kernel accumulates weights[i] * |v1[i] - v2[i]|^p over n features
+     * and returns the raw sum, without taking the p-th root. The bounded kernel
+     * adds BOUND_BLOCK features at a time and stops as soon as the running sum
+     * exceeds the bound; the blocks are always summed in the same order, so a
+     * sum that is not abandoned does not depend on the bound.
+     */
+    struct DistanceKernels {
+        const char* name;
+        float (*squaredEuclidean)(const float*, const float*, const float*, size_t);
+        float (*boundedSquaredEuclidean)(const float*, const float*, const float*, size_t, float);
+        float (*manhattan)(const float*, const float*, const float*, size_t);
+        float (*integerPower)(const float*, const float*, const float*, size_t, int);
+    };
+
+    float squaredEuclideanScalar(const float* v1, const float* v2, const float* weights, size_t n) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float diff = v1[i] - v2[i];
+            sum += weights[i] * diff * diff;
+        }
+        return sum;
+    }
+
+    // Number of features added between two checks of the bound.
+    constexpr size_t BOUND_BLOCK = 16;
+
+    float boundedSquaredEuclideanScalar(const float* v1, const float* v2, const float* weights, size_t n, float bound) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; i += BOUND_BLOCK) {
+            sum += squaredEuclideanScalar(v1 + i, v2 + i, weights + i, std::min(BOUND_BLOCK, n - i));
+            if (sum > bound) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    float manhattanScalar(const float* v1, const float* v2, const float* weights, size_t n) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            sum += weights[i] * std::abs(v1[i] - v2[i]);
+        }
+        return sum;
+    }
+
+    float integerPowerScalar(const float* v1, const float* v2, const float* weights, size_t n, int p) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float diff = std::abs(v1[i] - v2[i]);
+            float power = diff;
+            for (int k = 1; k < p; ++k) {
+                power *= diff;
+            }
+            sum += weights[i] * power;
+        }
+        return sum;
+    }
+
+#ifdef FWL_X86_KERNELS
+    __attribute__((target("sse4.1")))
+    float horizontalSum(__m128 v) {
+        __m128 shuffled = _mm_movehdup_ps(v);
+        __m128 sums = _mm_add_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        sums = _mm_add_ss(sums, shuffled);
+        return _mm_cvtss_f32(sums);
+    }
+
+    __attribute__((target("sse4.1")))
+    float squaredEuclideanSSE4(const float* v1, const float* v2, const float* weights, size_t n) {
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128 d0 = _mm_sub_ps(_mm_loadu_ps(v1 + i), _mm_loadu_ps(v2 + i));
+            __m128 d1 = _mm_sub_ps(_mm_loadu_ps(v1 + i + 4), _mm_loadu_ps(v2 + i + 4));
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(weights + i), _mm_mul_ps(d0, d0)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(weights + i + 4), _mm_mul_ps(d1, d1)));
+        }
+        float sum = horizontalSum(_mm_add_ps(acc0, acc1));
+        return sum + squaredEuclideanScalar(v1 + i, v2 + i, weights + i, n - i);
+    }
+
+    __attribute__((target("sse4.1")))
+    float boundedSquaredEuclideanSSE4(const float* v1, const float* v2, const float* weights, size_t n, float bound) {
+        float sum = 0.0f;
+        size_t i = 0;
+        for (; i + BOUND_BLOCK <= n; i += BOUND_BLOCK) {
+            __m128 acc = _mm_setzero_ps();
+            for (size_t k = i; k < i + BOUND_BLOCK; k += 4) {
+                __m128 d = _mm_sub_ps(_mm_loadu_ps(v1 + k), _mm_loadu_ps(v2 + k));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(weights + k), _mm_mul_ps(d, d)));
+            }
+            sum += horizontalSum(acc);
+            if (sum > bound) {
+                return sum;
+            }
+        }
+        return sum + squaredEuclideanScalar(v1 + i, v2 + i, weights + i, n - i);
+    }
+
+    __attribute__((target("sse4.1")))
+    float manhattanSSE4(const float* v1, const float* v2, const float* weights, size_t n) {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m128 d0 = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(v1 + i), _mm_loadu_ps(v2 + i)));
+            __m128 d1 = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(v1 + i + 4), _mm_loadu_ps(v2 + i + 4)));
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(weights + i), d0));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(weights + i + 4), d1));
+        }
+        float sum = horizontalSum(_mm_add_ps(acc0, acc1));
+        return sum + manhattanScalar(v1 + i, v2 + i, weights + i, n - i);
+    }
+
+    __attribute__((target("sse4.1")))
+    float integerPowerSSE4(const float* v1, const float* v2, const float* weights, size_t n, int p) {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 acc = _mm_setzero_ps();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m128 diff = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(v1 + i), _mm_loadu_ps(v2 + i)));
+            __m128 power = diff;
+            for (int k = 1; k < p; ++k) {
+                power = _mm_mul_ps(power, diff);
+            }
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(weights + i), power));
+        }
+        return horizontalSum(acc) + integerPowerScalar(v1 + i, v2 + i, weights + i, n - i, p);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float horizontalSum(__m256 v) {
+        __m128 sums = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        __m128 shuffled = _mm_movehdup_ps(sums);
+        sums = _mm_add_ps(sums, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        sums = _mm_add_ss(sums, shuffled);
+        return _mm_cvtss_f32(sums);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float squaredEuclideanAVX2(const float* v1, const float* v2, const float* weights, size_t n) {
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(v1 + i + 8), _mm256_loadu_ps(v2 + i + 8));
+            acc0 = _mm256_fmadd_ps(_mm256_mul_ps(d0, d0), _mm256_loadu_ps(weights + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_mul_ps(d1, d1), _mm256_loadu_ps(weights + i + 8), acc1);
+        }
+        for (; i + 8 <= n; i += 8) {
+            __m256 d = _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i));
+            acc0 = _mm256_fmadd_ps(_mm256_mul_ps(d, d), _mm256_loadu_ps(weights + i), acc0);
+        }
+        float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+        return sum + squaredEuclideanScalar(v1 + i, v2 + i, weights + i, n - i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float boundedSquaredEuclideanAVX2(const float* v1, const float* v2, const float* weights, size_t n, float bound) {
+        float sum = 0.0f;
+        size_t i = 0;
+        for (; i + BOUND_BLOCK <= n; i += BOUND_BLOCK) {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(v1 + i + 8), _mm256_loadu_ps(v2 + i + 8));
+            __m256 acc = _mm256_mul_ps(_mm256_mul_ps(d0, d0), _mm256_loadu_ps(weights + i));
+            acc = _mm256_fmadd_ps(_mm256_mul_ps(d1, d1), _mm256_loadu_ps(weights + i + 8), acc);
+            sum += horizontalSum(acc);
+            if (sum > bound) {
+                return sum;
+            }
+        }
+        return sum + squaredEuclideanScalar(v1 + i, v2 + i, weights + i, n - i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float manhattanAVX2(const float* v1, const float* v2, const float* weights, size_t n) {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            __m256 d0 = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i)));
+            __m256 d1 = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_loadu_ps(v1 + i + 8), _mm256_loadu_ps(v2 + i + 8)));
+            acc0 = _mm256_fmadd_ps(d0, _mm256_loadu_ps(weights + i), acc0);
+            acc1 = _mm256_fmadd_ps(d1, _mm256_loadu_ps(weights + i + 8), acc1);
+        }
+        for (; i + 8 <= n; i += 8) {
+            __m256 d = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i)));
+            acc0 = _mm256_fmadd_ps(d, _mm256_loadu_ps(weights + i), acc0);
+        }
+        float sum = horizontalSum(_mm256_add_ps(acc0, acc1));
+        return sum + manhattanScalar(v1 + i, v2 + i, weights + i, n - i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float integerPowerAVX2(const float* v1, const float* v2, const float* weights, size_t n, int p) {
+        const __m256 signMask = _mm256_set1_ps(-0.0f);
+        __m256 acc = _mm256_setzero_ps();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256 diff = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_loadu_ps(v1 + i), _mm256_loadu_ps(v2 + i)));
+            __m256 power = diff;
+            for (int k = 1; k < p; ++k) {
+                power = _mm256_mul_ps(power, diff);
+            }
+            acc = _mm256_fmadd_ps(power, _mm256_loadu_ps(weights + i), acc);
+        }
+        return horizontalSum(acc) + integerPowerScalar(v1 + i, v2 + i, weights + i, n - i, p);
+    }
+
+    __attribute__((target("avx512f")))
+    float horizontalSum(__m512 v) {
+        alignas(64) float lanes[16];
+        _mm512_store_ps(lanes, v);
+        float sum = 0.0f;
+        for (float lane : lanes) {
+            sum += lane;
+        }
+        return sum;
+    }
+
+    __attribute__((target("avx512f")))
+    float squaredEuclideanAVX512(const float* v1, const float* v2, const float* weights, size_t n) {
+        __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(v1 + i), _mm512_loadu_ps(v2 + i));
+            __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(v1 + i + 16), _mm512_loadu_ps(v2 + i + 16));
+            acc0 = _mm512_fmadd_ps(_mm512_mul_ps(d0, d0), _mm512_loadu_ps(weights + i), acc0);
+            acc1 = _mm512_fmadd_ps(_mm512_mul_ps(d1, d1), _mm512_loadu_ps(weights + i + 16), acc1);
+        }
+        for (; i + 16 <= n; i += 16) {
+            __m512 d = _mm512_sub_ps(_mm512_loadu_ps(v1 + i), _mm512_loadu_ps(v2 + i));
+            acc0 = _mm512_fmadd_ps(_mm512_mul_ps(d, d), _mm512_loadu_ps(weights + i), acc0);
+        }
+        if (i < n) {
+            // Masked loads keep the tail in registers instead of a scalar loop
+            __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+            __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, v1 + i), _mm512_maskz_loadu_ps(mask, v2 + i));
+            acc1 = _mm512_fmadd_ps(_mm512_mul_ps(d, d), _mm512_maskz_loadu_ps(mask, weights + i), acc1);
+        }
+        return horizontalSum(_mm512_add_ps(acc0, acc1));
+    }
+
+    __attribute__((target("avx512f")))
+    float boundedSquaredEuclideanAVX512(const float* v1, const float* v2, const float* weights, size_t n, float bound) {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; i += BOUND_BLOCK) {
+            __mmask16 mask = n - i >= BOUND_BLOCK ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+            __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, v1 + i), _mm512_maskz_loadu_ps(mask, v2 + i));
+            sum += horizontalSum(_mm512_mul_ps(_mm512_mul_ps(d, d), _mm512_maskz_loadu_ps(mask, weights + i)));
+            if (sum > bound) {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    __attribute__((target("avx512f")))
+    float manhattanAVX512(const float* v1, const float* v2, const float* weights, size_t n) {
+        __m512 acc0 = _mm512_setzero_ps(), acc1 = _mm512_setzero_ps();
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            __m512 d0 = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(v1 + i), _mm512_loadu_ps(v2 + i)));
+            __m512 d1 = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(v1 + i + 16), _mm512_loadu_ps(v2 + i + 16)));
+            acc0 = _mm512_fmadd_ps(d0, _mm512_loadu_ps(weights + i), acc0);
+            acc1 = _mm512_fmadd_ps(d1, _mm512_loadu_ps(weights + i + 16), acc1);
+        }
+        for (; i + 16 <= n; i += 16) {
+            __m512 d = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(v1 + i), _mm512_loadu_ps(v2 + i)));
+            acc0 = _mm512_fmadd_ps(d, _mm512_loadu_ps(weights + i), acc0);
+        }
+        if (i < n) {
+            __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+            __m512 d = _mm512_abs_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, v1 + i), _mm512_maskz_loadu_ps(mask, v2 + i)));
+            acc1 = _mm512_fmadd_ps(d, _mm512_maskz_loadu_ps(mask, weights + i), acc1);
+        }
+        return horizontalSum(_mm512_add_ps(acc0, acc1));
+    }
+
+    __attribute__((target("avx512f")))
+    float integerPowerAVX512(const float* v1, const float* v2, const float* weights, size_t n, int p) {
+        __m512 acc = _mm512_setzero_ps();
+        for (size_t i = 0; i < n; i += 16) {
+            __mmask16 mask = n - i >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+            __m512 diff = _mm512_abs_ps(_mm512_sub_ps(_mm512_maskz_loadu_ps(mask, v1 + i), _mm512_maskz_loadu_ps(mask, v2 + i)));
+            __m512 power = diff;
+            for (int k = 1; k < p; ++k) {
+                power = _mm512_mul_ps(power, diff);
+            }
+            acc = _mm512_fmadd_ps(power, _mm512_maskz_loadu_ps(mask, weights + i), acc);
+        }
+        return horizontalSum(acc);
+    }
+#endif
+
+    const DistanceKernels scalarKernels = {"scalar", squaredEuclideanScalar, boundedSquaredEuclideanScalar, manhattanScalar, integerPowerScalar};
+#ifdef FWL_X86_KERNELS
+    const DistanceKernels sse4Kernels = {"sse4", squaredEuclideanSSE4, boundedSquaredEuclideanSSE4, manhattanSSE4, integerPowerSSE4};
+    const DistanceKernels avx2Kernels = {"avx2", squaredEuclideanAVX2, boundedSquaredEuclideanAVX2, manhattanAVX2, integerPowerAVX2};
+    const DistanceKernels avx512Kernels = {"avx512", squaredEuclideanAVX512, boundedSquaredEuclideanAVX512, manhattanAVX512, integerPowerAVX512};
+#endif
+
+    // Checks whether the CPU can run the kernel set with the given name
+    bool isSupported(const char* name) {
+        if (std::strcmp(name, "scalar") == 0) {
+            return true;
+        }
+#ifdef FWL_X86_KERNELS
+        __builtin_cpu_init();
+        if (std::strcmp(name, "avx512") == 0) {
+            return __builtin_cpu_supports("avx512f");
+        }
+        if (std::strcmp(name, "avx2") == 0) {
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        }
+        if (std::strcmp(name, "sse4") == 0) {
+            return __builtin_cpu_supports("sse4.1");
+        }
+#endif
+        return false;
+    }
+
+    /**
+     * @brief Picks the widest kernel set supported by the CPU.
+     *
+     * The FWL_DISTANCE_KERNEL environment variable (scalar, sse4, avx2 or avx512)
+     * can force a narrower set, which is useful for benchmarking and debugging.
+     * An unknown value, or a set the CPU cannot run, is reported on the error
+     * stream and ignored.
+     */
+    const DistanceKernels& selectKernels() {
+        const char* requested = std::getenv("FWL_DISTANCE_KERNEL");
+        if (requested != nullptr && *requested == '\0') {
+            requested = nullptr;
+        }
+        if (requested != nullptr) {
+            bool known = false;
+            for (const char* name : {"scalar", "sse4", "avx2", "avx512"}) {
+                known = known || std::strcmp(requested, name) == 0;
+            }
+            if (!known) {
+                std::cerr << "Warning: Unknown FWL_DISTANCE_KERNEL value '" << requested
+                          << "', expected scalar, sse4, avx2 or avx512. Using the widest supported kernels." << std::endl;
+                requested = nullptr;
+            } else if (!isSupported(requested)) {
+                std::cerr << "Warning: FWL_DISTANCE_KERNEL=" << requested
+                          << " is not supported by this CPU. Using the widest supported kernels." << std::endl;
+                requested = nullptr;
+            }
+        }
+        auto allowed = [requested](const char* name) {
+            return (requested == nullptr || std::strcmp(requested, name) == 0) && isSupported(name);
+        };
+
+#ifdef FWL_X86_KERNELS
+        if (allowed("avx512")) {
+            return avx512Kernels;
+        }
+        if (allowed("avx2")) {
+            return avx2Kernels;
+        }
+        if (allowed("sse4")) {
+            return sse4Kernels;
+        }
+#endif
+        (void)allowed;
+        return scalarKernels;
+    }
+
+    const DistanceKernels& kernels() {
+        static const DistanceKernels& selected = selectKernels();
+        return selected;
+    }
+
+    // Integer exponents up to this value use the vectorized repeated-product kernel.
+    constexpr float MAX_INTEGER_POWER = 8.0f;
+}
+
+namespace MathUtils {
+    float weightedSquaredEuclideanDistance(const float* v1, const float* v2, const float* weights, size_t n) {
+        return kernels().squaredEuclidean(v1, v2, weights, n);
+    }
+
+    float weightedSquaredEuclideanDistanceBounded(const float* v1, const float* v2, const float* weights, size_t n, float bound) {
+        return kernels().boundedSquaredEuclidean(v1, v2, weights, n, bound);
+    }
+
+    float weightedManhattanDistance(const float* v1, const float* v2, const float* weights, size_t n) {
+        return kernels().manhattan(v1, v2, weights, n);
+    }
+
+    float weightedMinkowskiDistance(const float* v1, const float* v2, const float* weights, size_t n, float p) {
+        if (p == 2.0f) {
+            return std::sqrt(kernels().squaredEuclidean(v1, v2, weights, n));
+        }
+        if (p == 1.0f) {
+            return kernels().manhattan(v1, v2, weights, n);
+        }
+        if (p > 0.0f && p <= MAX_INTEGER_POWER && std::floor(p) == p) {
+            return std::pow(kernels().integerPower(v1, v2, weights, n, static_cast<int>(p)), 1.0f / p);
+        }
+
+        float sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += weights[i] * std::pow(std::abs(v1[i] - v2[i]), p);
+        }
+        return std::pow(sum, 1.0f / p);
+    }
+
+    float weightedEuclideanDistance(const float* v1, const float* v2, const float* weights, size_t n) {
+        return std::sqrt(kernels().squaredEuclidean(v1, v2, weights, n));
+    }
+
+    const char* getDistanceKernelName() {
+        return kernels().name;
+    }
+}
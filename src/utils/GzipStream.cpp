@@ -0,0 +1,76 @@
+#include "utils/GzipStream.hpp"
+#include <zlib.h>
+
+GzipStream::GzipStream(const std::string& filename) : opened(false), finished(false), failed(false), stopping(false) {
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        finished = true;
+        return;
+    }
+    gzbuffer(file, 1 << 18);
+    opened = true;
+    worker = std::thread(&GzipStream::decompress, this, static_cast<void*>(file));
+}
+
+GzipStream::~GzipStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void GzipStream::decompress(void* handle) {
+    gzFile file = static_cast<gzFile>(handle);
+    bool error = false;
+    while (true) {
+        std::string block(BLOCK_BYTES, '\0');
+        int length = gzread(file, block.data(), static_cast<unsigned>(block.size()));
+        if (length <= 0) {
+            int code;
+            gzerror(file, &code);
+            error = length < 0 || (code != Z_OK && code != Z_STREAM_END);
+            break;
+        }
+        block.resize(length);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return stopping || blocks.size() < MAX_QUEUED_BLOCKS; });
+        if (stopping) {
+            break;
+        }
+        blocks.push_back(std::move(block));
+        changed.notify_all();
+    }
+
+    // A truncated member is only reported by gzclose
+    error = gzclose(file) != Z_OK || error;
+    std::lock_guard<std::mutex> lock(mutex);
+    failed = error;
+    finished = true;
+    changed.notify_all();
+}
+
+bool GzipStream::next(std::string& block) {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return finished || !blocks.empty(); });
+    if (blocks.empty()) {
+        return false;
+    }
+    block = std::move(blocks.front());
+    blocks.pop_front();
+    changed.notify_all();
+    return true;
+}
+
+bool GzipStream::hasFailed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+bool GzipStream::isGzip(const char* data, size_t size) {
+    return size >= 2 && static_cast<unsigned char>(data[0]) == 0x1f && static_cast<unsigned char>(data[1]) == 0x8b;
+}
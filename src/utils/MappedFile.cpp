@@ -0,0 +1,34 @@
+#include "utils/MappedFile.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& filename) : contents(nullptr), length(0), opened(false) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+        length = static_cast<size_t>(info.st_size);
+        if (length == 0) {
+            opened = true;
+        } else {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                madvise(mapping, length, MADV_SEQUENTIAL);
+                contents = static_cast<const char*>(mapping);
+                opened = true;
+            }
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (contents != nullptr) {
+        munmap(const_cast<char*>(contents), length);
+    }
+}
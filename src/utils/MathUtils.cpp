@@ -68,28 +68,59 @@ namespace MathUtils {
     }
 
     float weightedMinkowskiDistance(const std::vector<float>& v1, const std::vector<float>& v2, const std::vector<float>& weights, float p) {
-        float sum = 0.0;
-        for (size_t i = 0; i < v1.size(); ++i) {
-            sum += weights[i] * std::pow(std::abs(v1[i] - v2[i]), p);
-        }
-        return std::pow(sum, 1.0f / p);
+        return weightedMinkowskiDistance(v1.data(), v2.data(), weights.data(), v1.size(), p);
     }
 
     float calculateDistance(const std::vector<float>& v1, const std::vector<float>& v2, const std::vector<float>& weights, float p) {
         return weightedMinkowskiDistance(v1, v2, weights, p);
     }
 
+    float calculateDistance(const float* v1, const float* v2, const float* weights, size_t n, float p) {
+        return weightedMinkowskiDistance(v1, v2, weights, n, p);
+    }
+
     float weightedEuclideanDistance(const std::vector<float>& v1, const std::vector<float>& v2, const std::vector<float>& weights) {
+        return weightedEuclideanDistance(v1.data(), v2.data(), weights.data(), v1.size());
+    }
+
+    float euclideanDistance(const std::vector<float>& v1, const std::vector<float>& v2) {
+        return euclideanDistance(v1.data(), v2.data(), v1.size());
+    }
+
+    float euclideanDistance(const float* v1, const float* v2, size_t n) {
         float sum = 0.0f;
-        for (size_t i = 0; i < v1.size(); ++i) {
+        for (size_t i = 0; i < n; ++i) {
             float diff = v1[i] - v2[i];
-            sum += weights[i] * diff * diff;
+            sum += diff * diff;
         }
 
         return std::sqrt(sum);
     }
 
-    float euclideanDistance(const std::vector<float>& v1, const std::vector<float>& v2) {
-        return weightedEuclideanDistance(v1, v2, std::vector<float>(v1.size(), 1.0f));
+    float weightedSquaredNorm(const SparseRow& row, const float* weights) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < row.size(); ++k) {
+            sum += weights[row.indices[k]] * row.values[k] * row.values[k];
+        }
+        return sum;
+    }
+
+    float weightedSquaredEuclideanDistance(const SparseRow& a, const SparseRow& b, const float* weights, float normA, float normB) {
+        float dot = 0.0f;
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size()) {
+            uint32_t indexA = a.indices[i];
+            uint32_t indexB = b.indices[j];
+            if (indexA == indexB) {
+                dot += weights[indexA] * a.values[i] * b.values[j];
+                ++i;
+                ++j;
+            } else if (indexA < indexB) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        return std::max(0.0f, normA + normB - 2.0f * dot);
     }
 }
@@ -0,0 +1,284 @@
+#include "utils/NpyArray.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <zlib.h>
+
+namespace {
+    constexpr char NPY_MAGIC[6] = {'\x93', 'N', 'U', 'M', 'P', 'Y'};
+    constexpr uint32_t ZIP_LOCAL_HEADER = 0x04034b50;
+    constexpr uint32_t ZIP_CENTRAL_HEADER = 0x02014b50;
+    constexpr uint32_t ZIP_END_OF_DIRECTORY = 0x06054b50;
+    constexpr uint32_t ZIP64_END_OF_DIRECTORY = 0x06064b50;
+    constexpr uint32_t ZIP64_LOCATOR = 0x07064b50;
+    constexpr uint16_t ZIP64_EXTRA_FIELD = 0x0001;
+
+    // Reads a little-endian integer of the given type at a possibly unaligned address.
+    template <typename T>
+    T readLittleEndian(const char* data) {
+        T value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    // Returns the text after "'key':" in a .npy header dictionary, or an empty view if the key is missing.
+    std::string headerValue(const std::string& header, const std::string& key) {
+        size_t position = header.find("'" + key + "'");
+        if (position == std::string::npos) {
+            return "";
+        }
+        position = header.find(':', position);
+        return position == std::string::npos ? "" : header.substr(position + 1);
+    }
+}
+
+NpyArray::NpyArray(const std::string& filename, const std::string& member)
+    : file(std::make_unique<MappedFile>(filename)), elements(nullptr), kind('\0'), itemSize(0), fortranOrder(false) {
+    if (!file->isOpen()) {
+        error = "Unable to open file: " + filename;
+        return;
+    }
+    bool parsed = member.empty() ? parseHeader(file->data(), file->size()) : openMember(member);
+    if (!parsed && error.empty()) {
+        error = "Invalid NumPy array: " + filename + (member.empty() ? "" : "/" + member);
+    }
+}
+
+bool NpyArray::parseHeader(const char* data, size_t length) {
+    if (length < 10 || std::memcmp(data, NPY_MAGIC, sizeof(NPY_MAGIC)) != 0) {
+        return false;
+    }
+    uint8_t major = static_cast<uint8_t>(data[6]);
+    size_t headerStart = major == 1 ? 10 : 12;
+    if (length < headerStart) {
+        return false;
+    }
+    size_t headerLength = major == 1 ? readLittleEndian<uint16_t>(data + 8) : readLittleEndian<uint32_t>(data + 8);
+    if (headerLength > length - headerStart) {
+        return false;
+    }
+    std::string header(data + headerStart, headerLength);
+
+    // descr is a quoted type string such as '<f4': byte order, kind, item size
+    std::string descr = headerValue(header, "descr");
+    size_t quote = descr.find('\'');
+    size_t closingQuote = descr.find('\'', quote + 1);
+    if (quote == std::string::npos || closingQuote == std::string::npos || closingQuote - quote < 4) {
+        return false;
+    }
+    std::string type = descr.substr(quote + 1, closingQuote - quote - 1);
+    kind = type[1];
+    itemSize = std::strtoul(type.c_str() + 2, nullptr, 10);
+    if (kind == 'U') {
+        itemSize *= 4;
+    }
+    bool validSize = (kind == 'f' && (itemSize == 4 || itemSize == 8)) ||
+                     ((kind == 'i' || kind == 'u') && (itemSize == 1 || itemSize == 2 || itemSize == 4 || itemSize == 8)) ||
+                     (kind == 'b' && itemSize == 1) || ((kind == 'U' || kind == 'S') && itemSize > 0);
+    if (!validSize) {
+        error = "Unsupported NumPy dtype: " + type;
+        return false;
+    }
+    if (type[0] == '>' && itemSize > 1 && kind != 'S') {
+        error = "Unsupported big-endian NumPy dtype: " + type;
+        return false;
+    }
+
+    std::string order = headerValue(header, "fortran_order");
+    size_t orderStart = order.find_first_not_of(" \t");
+    fortranOrder = orderStart != std::string::npos && order.compare(orderStart, 4, "True") == 0;
+
+    std::string shapeText = headerValue(header, "shape");
+    size_t open = shapeText.find('(');
+    size_t close = shapeText.find(')', open);
+    if (open == std::string::npos || close == std::string::npos) {
+        return false;
+    }
+    std::stringstream dimensions(shapeText.substr(open + 1, close - open - 1));
+    std::string dimension;
+    while (std::getline(dimensions, dimension, ',')) {
+        if (dimension.find_first_not_of(" \t") != std::string::npos) {
+            shape.push_back(std::strtoull(dimension.c_str(), nullptr, 10));
+        }
+    }
+
+    elements = data + headerStart + headerLength;
+    size_t available = length - headerStart - headerLength;
+    return size() <= available / itemSize;
+}
+
+bool NpyArray::openMember(const std::string& member) {
+    const char* data = file->data();
+    size_t size = file->size();
+    std::string name = member + ".npy";
+    auto fits = [size](uint64_t offset, uint64_t length) { return offset <= size && length <= size - offset; };
+
+    // The end of central directory record is at most 64 KiB of comment away from the end
+    size_t end = size;
+    if (size >= 22) {
+        size_t lowest = size - 22 > 65535 ? size - 22 - 65535 : 0;
+        for (size_t position = size - 22; end == size; --position) {
+            if (readLittleEndian<uint32_t>(data + position) == ZIP_END_OF_DIRECTORY) {
+                end = position;
+            }
+            if (position == lowest) {
+                break;
+            }
+        }
+    }
+    if (end == size) {
+        return false;
+    }
+
+    uint64_t numEntries = readLittleEndian<uint16_t>(data + end + 10);
+    uint64_t directoryOffset = readLittleEndian<uint32_t>(data + end + 16);
+    if (end >= 20 && readLittleEndian<uint32_t>(data + end - 20) == ZIP64_LOCATOR) {
+        uint64_t recordOffset = readLittleEndian<uint64_t>(data + end - 12);
+        if (!fits(recordOffset, 56) || readLittleEndian<uint32_t>(data + recordOffset) != ZIP64_END_OF_DIRECTORY) {
+            return false;
+        }
+        numEntries = readLittleEndian<uint64_t>(data + recordOffset + 32);
+        directoryOffset = readLittleEndian<uint64_t>(data + recordOffset + 48);
+    }
+
+    uint64_t offset = directoryOffset;
+    for (uint64_t entry = 0; entry < numEntries; ++entry) {
+        if (!fits(offset, 46) || readLittleEndian<uint32_t>(data + offset) != ZIP_CENTRAL_HEADER) {
+            return false;
+        }
+        uint16_t method = readLittleEndian<uint16_t>(data + offset + 10);
+        uint64_t compressedSize = readLittleEndian<uint32_t>(data + offset + 20);
+        uint64_t uncompressedSize = readLittleEndian<uint32_t>(data + offset + 24);
+        uint16_t nameLength = readLittleEndian<uint16_t>(data + offset + 28);
+        uint16_t extraLength = readLittleEndian<uint16_t>(data + offset + 30);
+        uint16_t commentLength = readLittleEndian<uint16_t>(data + offset + 32);
+        uint64_t localOffset = readLittleEndian<uint32_t>(data + offset + 42);
+        uint64_t next = offset + 46 + nameLength + extraLength + commentLength;
+        if (!fits(offset, next - offset)) {
+            return false;
+        }
+
+        if (std::string(data + offset + 46, nameLength) == name) {
+            // Sizes and offsets that do not fit in 32 bits are in the zip64 extra field, in this order
+            const char* extra = data + offset + 46 + nameLength;
+            for (size_t e = 0; e + 4 <= extraLength;) {
+                uint16_t id = readLittleEndian<uint16_t>(extra + e);
+                uint16_t length = readLittleEndian<uint16_t>(extra + e + 2);
+                const char* field = extra + e + 4;
+                const char* fieldEnd = field + std::min<size_t>(length, extraLength - e - 4);
+                if (id == ZIP64_EXTRA_FIELD) {
+                    for (uint64_t* value : {&uncompressedSize, &compressedSize, &localOffset}) {
+                        if (*value == 0xFFFFFFFF && field + 8 <= fieldEnd) {
+                            *value = readLittleEndian<uint64_t>(field);
+                            field += 8;
+                        }
+                    }
+                }
+                e += 4 + length;
+            }
+
+            if (!fits(localOffset, 30) || readLittleEndian<uint32_t>(data + localOffset) != ZIP_LOCAL_HEADER) {
+                return false;
+            }
+            uint64_t start = localOffset + 30 + readLittleEndian<uint16_t>(data + localOffset + 26) +
+                             readLittleEndian<uint16_t>(data + localOffset + 28);
+            if (!fits(start, compressedSize)) {
+                return false;
+            }
+
+            if (method == 0) {
+                return parseHeader(data + start, compressedSize);
+            }
+            if (method != Z_DEFLATED) {
+                error = "Unsupported compression in NumPy archive member: " + name;
+                return false;
+            }
+
+            inflated.resize(uncompressedSize);
+            z_stream stream = {};
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + start));
+            stream.avail_in = static_cast<uInt>(compressedSize);
+            stream.next_out = reinterpret_cast<Bytef*>(inflated.data());
+            stream.avail_out = static_cast<uInt>(uncompressedSize);
+            bool complete = inflateInit2(&stream, -MAX_WBITS) == Z_OK && inflate(&stream, Z_FINISH) == Z_STREAM_END &&
+                            stream.total_out == uncompressedSize;
+            inflateEnd(&stream);
+            return complete && parseHeader(inflated.data(), inflated.size());
+        }
+        offset = next;
+    }
+
+    error = "Array not found in NumPy archive: " + name;
+    return false;
+}
+
+size_t NpyArray::size() const {
+    return std::accumulate(shape.begin(), shape.end(), size_t(1), std::multiplies<size_t>());
+}
+
+double NpyArray::valueAt(size_t row, size_t column) const {
+    size_t numRows = shape.empty() ? 1 : shape[0];
+    size_t numColumns = shape.size() < 2 ? 1 : shape[1];
+    const char* element = elements + (fortranOrder ? column * numRows + row : row * numColumns + column) * itemSize;
+    switch (kind) {
+        case 'f':
+            return itemSize == 4 ? readLittleEndian<float>(element) : readLittleEndian<double>(element);
+        case 'i':
+            switch (itemSize) {
+                case 1: return readLittleEndian<int8_t>(element);
+                case 2: return readLittleEndian<int16_t>(element);
+                case 4: return readLittleEndian<int32_t>(element);
+                default: return static_cast<double>(readLittleEndian<int64_t>(element));
+            }
+        case 'u':
+            switch (itemSize) {
+                case 1: return readLittleEndian<uint8_t>(element);
+                case 2: return readLittleEndian<uint16_t>(element);
+                case 4: return readLittleEndian<uint32_t>(element);
+                default: return static_cast<double>(readLittleEndian<uint64_t>(element));
+            }
+        case 'b':
+            return element[0] != 0 ? 1.0 : 0.0;
+        default:
+            return 0.0;
+    }
+}
+
+std::string NpyArray::textAt(size_t index) const {
+    const char* element = elements + index * itemSize;
+    std::string text;
+    if (kind == 'S') {
+        text.assign(element, strnlen(element, itemSize));
+    } else if (kind == 'U') {
+        // UTF-32 code points, written back as UTF-8
+        for (size_t c = 0; c < itemSize / 4; ++c) {
+            uint32_t code = readLittleEndian<uint32_t>(element + 4 * c);
+            if (code == 0) {
+                break;
+            }
+            if (code < 0x80) {
+                text += static_cast<char>(code);
+            } else if (code < 0x800) {
+                text += static_cast<char>(0xC0 | (code >> 6));
+                text += static_cast<char>(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                text += static_cast<char>(0xE0 | (code >> 12));
+                text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (code & 0x3F));
+            } else {
+                text += static_cast<char>(0xF0 | (code >> 18));
+                text += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                text += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (code & 0x3F));
+            }
+        }
+    } else {
+        std::ostringstream number;
+        number << valueAt(index);
+        text = number.str();
+    }
+    return text;
+}
@@ -1,36 +1,62 @@
 #include "utils/random.hpp"
+#include "utils/RandomUtils.hpp"
 #include <vector>
 #include <algorithm>
 
 namespace RandomUtils {
     using Random = effolkronium::random_static;
 
+    namespace {
+        // The generator of the calling thread, or nullptr to use the shared one
+        thread_local std::mt19937* threadGenerator = nullptr;
+    }
+
     void seedRandom(unsigned int seedValue) {
         Random::seed(seedValue);
     }
 
+    void setThreadGenerator(std::mt19937* generator) {
+        threadGenerator = generator;
+    }
+
+    std::mt19937& getGenerator() {
+        return threadGenerator != nullptr ? *threadGenerator : Random::engine();
+    }
+
     int getRandomInt(int min, int max) {
-        return Random::get(min, max);
+        if (threadGenerator == nullptr) {
+            return Random::get(min, max);
+        }
+        // Same as Random::get, which accepts the limits in any order
+        return min < max ? std::uniform_int_distribution<int>(min, max)(*threadGenerator)
+                         : std::uniform_int_distribution<int>(max, min)(*threadGenerator);
     }
 
     float getRandomFloat(float min, float max) {
-        return Random::get(min, max);
+        if (threadGenerator == nullptr) {
+            return Random::get(min, max);
+        }
+        return min < max ? std::uniform_real_distribution<float>(min, max)(*threadGenerator)
+                         : std::uniform_real_distribution<float>(max, min)(*threadGenerator);
     }
 
     float getRandomNormal(float mean, float sigma) {
-        return Random::get<std::normal_distribution<>>(mean, sigma);
+        if (threadGenerator == nullptr) {
+            return Random::get<std::normal_distribution<>>(mean, sigma);
+        }
+        return std::normal_distribution<>(mean, sigma)(*threadGenerator);
     }
 
     std::vector<size_t> generateShuffledIndices(size_t n) {
         std::vector<size_t> indices(n);
         std::iota(indices.begin(), indices.end(), 0);
-        Random::shuffle(indices);
+        std::shuffle(indices.begin(), indices.end(), getGenerator());
         return indices;
     }
 
     std::vector<size_t> shuffleIntArray(const std::vector<size_t>& array, size_t initialIndex) {
         std::vector<size_t> shuffledArray(array);
-        std::shuffle(shuffledArray.begin() + initialIndex, shuffledArray.end(), Random::engine());
+        std::shuffle(shuffledArray.begin() + initialIndex, shuffledArray.end(), getGenerator());
         return shuffledArray;
     }
     
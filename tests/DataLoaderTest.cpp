@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include "data/DataLoader.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+TEST(DataLoaderTest, ReadsRowsWithAnAtSignOutsideTheirFirstCharacter) {
+    std::string filename = (std::filesystem::temp_directory_path() / ("fwl-test-" + std::to_string(::getpid()) + ".arff")).string();
+    {
+        std::ofstream out(filename);
+        out << "@relation mail\n\n"
+            << "  @attribute F0 real\n@attribute F1 real\n"
+            << "@attribute Class {user@a,user@b}\n\n"
+            << "\t@data\n"
+            << "% a comment mentioning @data\n"
+            << "1.0,2.0,user@a\n"
+            << "  3.0,4.0,user@b\n"
+            << "5.0,6.0,user@a\n";
+    }
+
+    DataSet dataset;
+    bool read = DataLoader::readARFF(filename, dataset);
+    std::filesystem::remove(filename);
+
+    ASSERT_TRUE(read);
+    ASSERT_EQ(dataset.size(), 3u);
+    EXPECT_EQ(dataset.getNumFeatures(), 2);
+    EXPECT_EQ(dataset.getLabel(0), "user@a");
+    EXPECT_EQ(dataset.getLabel(1), "user@b");
+    EXPECT_FLOAT_EQ(dataset[1][0], 3.0f);
+    EXPECT_FLOAT_EQ(dataset[2][1], 6.0f);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "Evaluation.hpp"
+#include "algorithms/1NN.hpp"
+#include "data/DataSet.hpp"
+#include "Solution.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr size_t NUM_DISTINCT_ROWS = 500;
+    constexpr size_t NUM_COPIES = 150;
+    constexpr size_t NUM_FEATURES = 64;
+    constexpr size_t CONSTANT_FEATURE = 5;
+    constexpr float ALPHA = 0.5f;
+    constexpr float REDUCTION_THRESHOLD = 0.1f;
+
+    // Rows of small integers over three classes, followed by copies of some of them, half of those with
+    // another class. Distances are exact in any order, and with few active features many of them tie.
+    DataSet makeDataSet(std::mt19937& generator) {
+        std::uniform_int_distribution<int> value(0, 2);
+        DataSet dataset;
+        std::vector<ClassId> classes = {dataset.addClassLabel("a"), dataset.addClassLabel("b"), dataset.addClassLabel("c")};
+        std::vector<float> row(NUM_FEATURES);
+        for (size_t i = 0; i < NUM_DISTINCT_ROWS; ++i) {
+            for (size_t j = 0; j < NUM_FEATURES; ++j) {
+                row[j] = j == CONSTANT_FEATURE ? 1.0f : static_cast<float>(value(generator));
+            }
+            dataset.addRow(row.data(), row.size(), classes[value(generator)]);
+        }
+
+        std::uniform_int_distribution<size_t> source(0, NUM_DISTINCT_ROWS - 1);
+        for (size_t c = 0; c < NUM_COPIES; ++c) {
+            size_t i = source(generator);
+            ClassId classId = c % 2 == 0 ? dataset.getClassId(i) : classes[(dataset.getClassId(i) + 1) % classes.size()];
+            // Adding a row may move the rows, so the copy is taken first
+            row.assign(dataset.row(i).begin(), dataset.row(i).begin() + NUM_FEATURES);
+            dataset.addRow(row.data(), row.size(), classId);
+        }
+        return dataset;
+    }
+
+    // Weights that are zero or powers of two, keeping every weighted sum exact. With a few active
+    // features most distances tie, with all of them the scan spans several tiles.
+    std::vector<Solution> makeSolutions(std::mt19937& generator) {
+        std::uniform_int_distribution<int> exponent(-2, 2);
+        std::uniform_real_distribution<float> draw(0.0f, 1.0f);
+        std::vector<Solution> solutions;
+        for (float density : {1.0f, 0.05f, 0.5f, 1.0f, 0.1f, 0.8f}) {
+            Solution solution(NUM_FEATURES, 0.0f);
+            for (size_t j = 0; j < NUM_FEATURES; ++j) {
+                solution.weights[j] = draw(generator) < density ? std::ldexp(1.0f, exponent(generator)) : 0.0f;
+            }
+            solutions.push_back(solution);
+        }
+        return solutions;
+    }
+
+    // The leave-one-out classification rate of a plain scan of every other row, the lowest index winning ties
+    float referenceClassificationRate(const DataSet& dataset, const Solution& solution) {
+        OneNN classifier(dataset);
+        size_t correct = 0;
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            correct += classifier.classifyExcludingIndex(dataset.row(i), i, solution) == dataset.getClassId(i);
+        }
+        return static_cast<float>(correct) / dataset.size() * 100.0f;
+    }
+
+    // Checks every evaluation path of one evaluation against the reference rates
+    void checkEvaluation(Evaluation& eval, const DataSet& dataset, const std::vector<Solution>& solutions,
+                         const std::vector<float>& expectedRates) {
+        std::vector<EvaluationResult> results = eval.evaluateBatch(solutions);
+        ASSERT_EQ(results.size(), solutions.size());
+        for (size_t s = 0; s < solutions.size(); ++s) {
+            float expectedFitness = eval.calculateFitness(expectedRates[s], eval.calculateReductionRate(solutions[s]));
+            EXPECT_FLOAT_EQ(results[s].classificationRate, expectedRates[s]) << "solution " << s;
+            EXPECT_FLOAT_EQ(results[s].fitness, expectedFitness) << "solution " << s;
+            // Every scan after the first is seeded with the neighbors of the previous solution
+            EXPECT_FLOAT_EQ(eval.calculateFitnessLeaveOneOut(dataset, solutions[s]), expectedFitness) << "solution " << s;
+        }
+        // Seeds left by the last solution must not change the result of the first one
+        float expectedFitness = eval.calculateFitness(expectedRates[0], eval.calculateReductionRate(solutions[0]));
+        EXPECT_FLOAT_EQ(eval.calculateFitnessLeaveOneOut(dataset, solutions[0]), expectedFitness);
+    }
+}
+
+TEST(EvaluationTest, AllPathsMatchAPlainLeaveOneOutScan) {
+    std::mt19937 generator(777);
+    DataSet dataset = makeDataSet(generator);
+    std::vector<Solution> solutions = makeSolutions(generator);
+    std::vector<float> expectedRates;
+    for (const Solution& solution : solutions) {
+        expectedRates.push_back(referenceClassificationRate(dataset, solution));
+    }
+
+    // No fitness cache, so every evaluation really scans the data
+    Evaluation eval(dataset, ALPHA, REDUCTION_THRESHOLD, 0);
+    ASSERT_EQ(eval.getNumLeaveOneOutRows(), dataset.size());
+    checkEvaluation(eval, dataset, solutions, expectedRates);
+}
+
+TEST(EvaluationTest, DeduplicatedPathsMatchAPlainLeaveOneOutScan) {
+    std::mt19937 generator(777);
+    DataSet dataset = makeDataSet(generator);
+    std::vector<Solution> solutions = makeSolutions(generator);
+    std::vector<float> expectedRates;
+    for (const Solution& solution : solutions) {
+        expectedRates.push_back(referenceClassificationRate(dataset, solution));
+    }
+
+    Evaluation eval(dataset, ALPHA, REDUCTION_THRESHOLD, 0, Evaluation::DEFAULT_MEMORY_BUDGET, true);
+    ASSERT_LT(eval.getNumLeaveOneOutRows(), dataset.size());
+    checkEvaluation(eval, dataset, solutions, expectedRates);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "FitnessCache.hpp"
+
+#include <vector>
+
+TEST(FitnessCacheTest, FindsOnlyTheSameReducedWeights) {
+    FitnessCache cache(size_t(1) << 20);
+    std::vector<float> weights = {0.0f, 0.4f, 0.0f, 0.9f, 0.0f};
+    cache.insert(weights, 75.0f);
+
+    float rate = 0.0f;
+    EXPECT_TRUE(cache.find(weights, rate));
+    EXPECT_FLOAT_EQ(rate, 75.0f);
+
+    // A weight that only differs by being non-zero, a different value or a different length never matches
+    EXPECT_FALSE(cache.find({0.0f, 0.4f, 0.1f, 0.9f, 0.0f}, rate));
+    EXPECT_FALSE(cache.find({0.0f, 0.4f, 0.0f, 0.8f, 0.0f}, rate));
+    EXPECT_FALSE(cache.find({0.0f, 0.4f, 0.0f, 0.9f}, rate));
+    EXPECT_FALSE(cache.find({0.0f, 0.4f, 0.0f, 0.9f, 0.0f, 0.0f}, rate));
+    EXPECT_EQ(cache.getHits(), 1u);
+    EXPECT_EQ(cache.getMisses(), 4u);
+}
+
+TEST(FitnessCacheTest, StaysWithinItsCapacityInBytes) {
+    // Wide keys with few non-zero weights, as solutions on wide datasets are
+    constexpr size_t numWeights = 10000;
+    constexpr size_t numKeys = 4096;
+    FitnessCache cache(size_t(64) << 10);
+    for (size_t k = 0; k < numKeys; ++k) {
+        std::vector<float> weights(numWeights, 0.0f);
+        weights[k] = 0.5f;
+        cache.insert(weights, static_cast<float>(k));
+    }
+
+    // The most recent keys are kept, the oldest ones were evicted
+    std::vector<float> weights(numWeights, 0.0f);
+    float rate = 0.0f;
+    weights[numKeys - 1] = 0.5f;
+    EXPECT_TRUE(cache.find(weights, rate));
+    EXPECT_FLOAT_EQ(rate, static_cast<float>(numKeys - 1));
+    weights[numKeys - 1] = 0.0f;
+    weights[0] = 0.5f;
+    EXPECT_FALSE(cache.find(weights, rate));
+}
+
+TEST(FitnessCacheTest, ZeroCapacityDisablesTheCache) {
+    FitnessCache cache(0);
+    float rate = 0.0f;
+    cache.insert({0.5f}, 50.0f);
+    EXPECT_FALSE(cache.isEnabled());
+    EXPECT_FALSE(cache.find({0.5f}, rate));
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "data/FoldManager.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    // A directory of its own for the files of a test, removed afterwards
+    class TempDirectory {
+    public:
+        TempDirectory() : path(std::filesystem::temp_directory_path() / ("fwl-test-" + std::to_string(::getpid()))) {
+            std::filesystem::create_directories(path);
+        }
+        ~TempDirectory() { std::filesystem::remove_all(path); }
+        std::string file(const std::string& name) const { return (path / name).string(); }
+
+    private:
+        std::filesystem::path path;
+    };
+
+    // Writes a partition of four rows with two features and two classes
+    void writePartition(const std::string& filename, float offset) {
+        std::ofstream out(filename);
+        out << "@relation test\n\n@attribute F0 real\n@attribute F1 real\n@attribute Class {x,y}\n\n@data\n";
+        for (int i = 0; i < 4; ++i) {
+            out << offset + i << "," << offset - i << "," << (i % 2 == 0 ? "x" : "y") << "\n";
+        }
+    }
+}
+
+TEST(FoldManagerTest, RejectsACacheWhoseSizesOverflow) {
+    TempDirectory directory;
+    std::vector<std::string> filenames = {directory.file("p_1.arff"), directory.file("p_2.arff")};
+    writePartition(filenames[0], 1.0f);
+    writePartition(filenames[1], 5.0f);
+    std::string cachePath = directory.file("p.fwcache");
+
+    FoldManager written;
+    ASSERT_TRUE(written.load(filenames, cachePath));
+    ASSERT_TRUE(std::filesystem::exists(cachePath));
+
+    // With the top bit set, twice the number of features and an even number of rows times the stride
+    // wrap around to their original values, so only an explicit bound rejects the header
+    FoldManager::CacheHeader header;
+    {
+        std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.numFeatures += uint64_t(1) << 63;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    FoldManager reloaded;
+    ASSERT_TRUE(reloaded.load(filenames, cachePath));
+    ASSERT_EQ(reloaded.getNumFolds(), 2u);
+    DataSet test = reloaded.getTestSet(1);
+    EXPECT_EQ(test.getNumFeatures(), 2);
+    EXPECT_EQ(test.size(), 4u);
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "IncrementalEvaluator.hpp"
+#include "Evaluation.hpp"
+#include "data/DataSet.hpp"
+#include "Solution.hpp"
+
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr size_t NUM_ROWS = 80;
+    constexpr size_t NUM_FEATURES = 8;
+    constexpr size_t CONSTANT_FEATURE = 3;
+    constexpr float ALPHA = 0.5f;
+    constexpr float REDUCTION_THRESHOLD = 0.1f;
+
+    // Random rows in [0, 1] over three classes, with one constant feature
+    DataSet makeDataSet(std::mt19937& generator) {
+        std::uniform_real_distribution<float> value(0.0f, 1.0f);
+        DataSet dataset;
+        std::vector<ClassId> classes = {dataset.addClassLabel("a"), dataset.addClassLabel("b"), dataset.addClassLabel("c")};
+        std::vector<float> row(NUM_FEATURES);
+        for (size_t i = 0; i < NUM_ROWS; ++i) {
+            for (size_t j = 0; j < NUM_FEATURES; ++j) {
+                row[j] = j == CONSTANT_FEATURE ? 0.5f : value(generator);
+            }
+            dataset.addRow(row.data(), row.size(), classes[i % classes.size()]);
+        }
+        return dataset;
+    }
+
+    // Proposes single-weight moves along a random walk, committing most of
+    // them, and checks every score against a full leave-one-out evaluation
+    void checkRandomWalk(size_t resyncInterval, size_t numMoves) {
+        std::mt19937 generator(12345);
+        DataSet dataset = makeDataSet(generator);
+        // No fitness cache, so every full evaluation really scans the data
+        auto eval = std::make_shared<Evaluation>(dataset, ALPHA, REDUCTION_THRESHOLD, 0);
+        IncrementalEvaluator incremental(eval, dataset, IncrementalEvaluator::DEFAULT_MEMORY_BUDGET, resyncInterval);
+        ASSERT_TRUE(incremental.isEnabled());
+
+        std::uniform_real_distribution<float> value(0.0f, 1.0f);
+        std::uniform_int_distribution<size_t> feature(0, NUM_FEATURES - 1);
+        Solution current(NUM_FEATURES, 0.5f);
+        EXPECT_FLOAT_EQ(incremental.reset(current), eval->calculateFitnessLeaveOneOut(dataset, current));
+
+        size_t commits = 0;
+        for (size_t move = 0; move < numMoves; ++move) {
+            Solution neighbor = current;
+            size_t index = feature(generator);
+            neighbor.weights[index] = value(generator);
+
+            float expected = eval->calculateFitnessLeaveOneOut(dataset, neighbor);
+            EXPECT_FLOAT_EQ(incremental.propose(neighbor, index), expected)
+                << "move " << move << " after " << commits << " commits";
+
+            if (value(generator) < 0.7f) {
+                incremental.commit();
+                current = neighbor;
+                ++commits;
+            } else {
+                incremental.rollback();
+            }
+        }
+        EXPECT_GT(commits, 2 * resyncInterval);
+    }
+}
+
+TEST(IncrementalEvaluatorTest, MatchesFullEvaluationAcrossResyncs) {
+    checkRandomWalk(5, 60);
+}
+
+TEST(IncrementalEvaluatorTest, MatchesFullEvaluationWithoutResync) {
+    // The interval outlasts the walk, so the accumulated updates are never recomputed
+    checkRandomWalk(100, 300);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "algorithms/1NN.hpp"
+#include "data/DataSet.hpp"
+#include "Solution.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+    constexpr size_t NUM_ROWS = 60;
+    constexpr size_t NUM_FEATURES = 6;
+    constexpr size_t CONSTANT_FEATURE = 2;
+
+    // Small integer rows over three classes, so distances are exact in any order and ties are common
+    DataSet makeDataSet(std::mt19937& generator) {
+        std::uniform_int_distribution<int> value(0, 3);
+        DataSet dataset;
+        std::vector<ClassId> classes = {dataset.addClassLabel("a"), dataset.addClassLabel("b"), dataset.addClassLabel("c")};
+        std::vector<float> row(NUM_FEATURES);
+        for (size_t i = 0; i < NUM_ROWS; ++i) {
+            for (size_t j = 0; j < NUM_FEATURES; ++j) {
+                row[j] = j == CONSTANT_FEATURE ? 1.0f : static_cast<float>(value(generator));
+            }
+            dataset.addRow(row.data(), row.size(), classes[(i / 2) % classes.size()]);
+        }
+        return dataset;
+    }
+}
+
+TEST(OneNNTest, SingleQueriesMatchAPreparedSearch) {
+    std::mt19937 generator(2024);
+    DataSet dataset = makeDataSet(generator);
+    OneNN classifier(dataset);
+
+    // Weights that are powers of two keep every weighted sum exact
+    std::uniform_int_distribution<int> exponent(-2, 2);
+    for (int trial = 0; trial < 5; ++trial) {
+        Solution solution(NUM_FEATURES, 0.0f);
+        for (size_t j = 0; j < NUM_FEATURES; ++j) {
+            solution.weights[j] = j == 0 && trial % 2 == 0 ? 0.0f : std::ldexp(1.0f, exponent(generator));
+        }
+        OneNN::SearchData search = classifier.prepare(solution);
+
+        for (size_t i = 0; i < dataset.size(); ++i) {
+            EXPECT_EQ(classifier.classify(dataset.row(i), solution), classifier.classify(search, dataset.row(i)))
+                << "trial " << trial << " row " << i;
+            EXPECT_EQ(classifier.classifyExcludingIndex(dataset.row(i), i, solution), classifier.classify(search, dataset.row(i), i))
+                << "trial " << trial << " row " << i;
+        }
+    }
+}